@@ -0,0 +1,588 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026
+
+    Console bench for the processor. Every table it prints comes from the plugin's
+    own code (same sources, same parameters), run offline on a fixed signal.
+    Release build only, one section per argument or all of them:
+
+        LabeurreBench [kernel] [adaa] [tanh] [modes] [control] [crossover] [precision]
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/fastTanh.h"
+
+//==============================================================================
+// A processor on one bus layout, its parameters set before prepareToPlay like a host restoring a preset.
+// The sidechain bus stays off, every parameter not listed keeps its default. The precision is picked before
+// prepareToPlay too, a rig only renders in that one
+class Rig
+{
+public:
+    using Parameters = std::vector<std::pair<juce::String, float>>;
+
+    Rig(const juce::AudioChannelSet& layout, double sampleRateToUse, int blockSizeToUse, const Parameters& parameters,
+        juce::AudioProcessor::ProcessingPrecision precision = juce::AudioProcessor::singlePrecision)
+        : sampleRate(sampleRateToUse), blockSize(blockSizeToUse)
+    {
+        auto buses = processor.getBusesLayout();
+        buses.inputBuses.getReference(0) = layout;
+        buses.outputBuses.getReference(0) = layout;
+
+        for (int bus = 1; bus < buses.inputBuses.size(); ++bus)
+            buses.inputBuses.getReference(bus) = juce::AudioChannelSet::disabled();
+
+        const bool accepted = processor.setBusesLayout(buses);
+        jassert(accepted);
+        juce::ignoreUnused(accepted);
+
+        for (const auto& [id, value] : parameters)
+            set(id, value);
+
+        processor.setProcessingPrecision(precision);
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+        block.setSize(layout.size(), blockSize);
+        doubleBlock.setSize(layout.size(), blockSize);
+    }
+
+    ~Rig() { processor.releaseResources(); }
+
+    // in the parameter's own units (choice index, bool 0 / 1)
+    void set(const juce::String& id, float value)
+    {
+        auto* parameter = processor.apvts.getParameter(id);
+        jassert(parameter != nullptr);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    int getNumChannels() const noexcept { return block.getNumChannels(); }
+    double getSampleRate() const noexcept { return sampleRate; }
+
+    // input through processBlock in blockSize pieces, into output (input's length, the rig's channels), in the
+    // output's precision. Returns the seconds spent inside processBlock, the copies around it don't count
+    template <typename SampleType>
+    double render(const juce::AudioBuffer<float>& input, juce::AudioBuffer<SampleType>& output)
+    {
+        jassert((processor.isUsingDoublePrecision() == std::is_same_v<SampleType, double>));
+
+        auto& hostBlock = getBlock<SampleType>();
+        double seconds = 0.0;
+
+        for (int start = 0; start < input.getNumSamples(); start += blockSize)
+        {
+            const int numSamples = juce::jmin(blockSize, input.getNumSamples() - start);
+            hostBlock.setSize(getNumChannels(), numSamples, false, false, true);
+
+            for (int channel = 0; channel < getNumChannels(); ++channel)
+            {
+                const float* source = input.getReadPointer(channel % input.getNumChannels(), start);
+                std::copy(source, source + numSamples, hostBlock.getWritePointer(channel));
+            }
+
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            processor.processBlock(hostBlock, midi);
+            seconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+            for (int channel = 0; channel < getNumChannels(); ++channel)
+                output.copyFrom(channel, start, hostBlock, channel, 0, numSamples);
+        }
+
+        return seconds;
+    }
+
+private:
+    template <typename SampleType>
+    juce::AudioBuffer<SampleType>& getBlock() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleBlock;
+        else
+            return block;
+    }
+
+    SimpleEQAudioProcessor processor;
+    double sampleRate;
+    int blockSize;
+
+    juce::AudioBuffer<float> block;
+    juce::AudioBuffer<double> doubleBlock;
+    juce::MidiBuffer midi;
+};
+
+
+//==============================================================================
+// SIGNALS AND MEASUREMENTS
+
+// the same every run: noise under a 3 Hz swell (the detectors keep moving) over a 220 Hz tone, -6 dBFS peaks
+static juce::AudioBuffer<float> makeProgramme(int numChannels, double sampleRate, double seconds)
+{
+    juce::AudioBuffer<float> buffer(numChannels, (int) (seconds * sampleRate));
+    juce::Random random(0x1abe);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        float* data = buffer.getWritePointer(channel);
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            const double t = i / sampleRate;
+            const float swell = 0.5f + 0.5f * (float) std::sin(juce::MathConstants<double>::twoPi * 3.0 * t);
+            const float tone = (float) std::sin(juce::MathConstants<double>::twoPi * 220.0 * t + channel);
+
+            data[i] = 0.25f * swell * (2.0f * random.nextFloat() - 1.0f) + 0.25f * tone;
+        }
+    }
+
+    return buffer;
+}
+
+
+// ns per sample and channel: one pass to warm up (caches, detectors, delay lines), then the fastest of three,
+// so a run the scheduler cut into doesn't count. SampleType is the precision the rig was prepared for
+template <typename SampleType = float>
+static double measureCost(Rig& rig, const juce::AudioBuffer<float>& input)
+{
+    juce::AudioBuffer<SampleType> output(rig.getNumChannels(), input.getNumSamples());
+    rig.render(input, output);
+
+    double best = std::numeric_limits<double>::max();
+
+    for (int run = 0; run < 3; ++run)
+        best = juce::jmin(best, rig.render(input, output));
+
+    return best * 1.0e9 / ((double) input.getNumSamples() * rig.getNumChannels());
+}
+
+
+// share of one core a channel takes at that rate, in percent
+static double getLoad(double nanosecondsPerSample, double sampleRate)
+{
+    return nanosecondsPerSample * 1.0e-9 * sampleRate * 100.0;
+}
+
+
+// a sine exactly on an FFT bin, so its harmonics land on bins too and nothing leaks between them
+static juce::AudioBuffer<float> makeBinSine(int numChannels, double sampleRate, int fftSize, int bin, float gain, double seconds)
+{
+    juce::AudioBuffer<float> buffer(numChannels, (int) (seconds * sampleRate));
+    const double step = juce::MathConstants<double>::twoPi * bin / fftSize;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            buffer.setSample(channel, i, gain * (float) std::sin(step * i));
+
+    return buffer;
+}
+
+
+// energy away from the harmonics of a bin-centred sine against all of it, in dB: what folded back from above Nyquist.
+// Hann window, the three bins either side of a harmonic are its main lobe; DC and the bins next to it are skipped
+static double measureAliasing(const float* data, int fftOrder, int fundamentalBin)
+{
+    const int fftSize = 1 << fftOrder;
+    juce::dsp::FFT fft(fftOrder);
+    std::vector<float> spectrum((size_t) (2 * fftSize), 0.0f);
+
+    for (int i = 0; i < fftSize; ++i)
+        spectrum[(size_t) i] = data[i] * 0.5f * (1.0f - (float) std::cos(juce::MathConstants<double>::twoPi * i / fftSize));
+
+    fft.performFrequencyOnlyForwardTransform(spectrum.data());
+
+    double harmonic = 0.0, aliased = 0.0;
+
+    for (int bin = 4; bin < fftSize / 2; ++bin)
+    {
+        const double energy = (double) spectrum[(size_t) bin] * spectrum[(size_t) bin];
+        const int nearestHarmonic = juce::roundToInt((double) bin / fundamentalBin) * fundamentalBin;
+
+        if (nearestHarmonic > 0 && std::abs(bin - nearestHarmonic) <= 3)
+            harmonic += energy;
+        else
+            aliased += energy;
+    }
+
+    return 10.0 * std::log10(aliased / (harmonic + aliased) + 1.0e-30);
+}
+
+
+static void printHeader(const char* title)
+{
+    std::printf("\n=== %s ===\n\n", title);
+}
+
+
+//==============================================================================
+// KERNEL: two minimum phase bands run a stereo pair through the SIMD kernel, a mono channel through the band engine.
+// Same stages and settings either way, per channel
+static void benchmarkKernel()
+{
+    printHeader("SIMD kernel vs band engine (2 bands, minimum phase, 512 sample blocks)");
+    std::printf("%10s  %18s  %18s  %8s\n", "rate", "band engine ns/smp", "kernel ns/smp", "speedup");
+
+    const Rig::Parameters parameters = { { "numBands", 2.0f }, { "crossoverMode", 0.0f } };
+
+    for (double sampleRate : { 44100.0, 96000.0, 192000.0 })
+    {
+        const auto input = makeProgramme(2, sampleRate, 1.0);
+
+        Rig bandEngine(juce::AudioChannelSet::mono(), sampleRate, 512, parameters);
+        Rig kernel(juce::AudioChannelSet::stereo(), sampleRate, 512, parameters);
+
+        const double scalar = measureCost(bandEngine, input);
+        const double simd = measureCost(kernel, input);
+
+        std::printf("%10.0f  %11.1f (%4.1f%%)  %11.1f (%4.1f%%)  %7.2fx\n", sampleRate,
+                    scalar, getLoad(scalar, sampleRate), simd, getLoad(simd, sampleRate), scalar / simd);
+    }
+}
+
+
+//==============================================================================
+// ADAA: the three curves at full drive, plain or ADAA at every oversampling factor. Cost on the stereo kernel,
+// aliasing on a 5 kHz sine at 48 kHz (bin 1701 of 16384), compressors off so only the shaper bends it
+static void benchmarkAntiAliasing()
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int fftOrder = 14, fundamentalBin = 1701;
+
+    printHeader("ADAA vs oversampling (2 bands, full drive, 5 kHz sine at 48 kHz, 512 sample blocks)");
+    std::printf("%8s  %6s  %5s  %12s  %12s\n", "curve", "factor", "ADAA", "ns/smp", "aliasing dB");
+
+    const auto input = makeBinSine(2, sampleRate, 1 << fftOrder, fundamentalBin, 0.5f, 1.0);
+    const char* curves[] = { "WARM", "CRUSH", "DON'T" };
+
+    for (int curve = 0; curve < 3; ++curve)
+    {
+        for (int factorIndex = 0; factorIndex < 4; ++factorIndex)
+        {
+            for (bool adaa : { false, true })
+            {
+                Rig rig(juce::AudioChannelSet::stereo(), sampleRate, 512,
+                        { { "numBands", 2.0f }, { "distortionType", 0.5f * curve }, { "distLowIntensity", 1.0f },
+                          { "distHighIntensity", 1.0f }, { "compLowIntensity", 0.0f }, { "compHighIntensity", 0.0f },
+                          { "oversampling", (float) factorIndex }, { "distortionADAA", adaa ? 1.0f : 0.0f } });
+
+                const double cost = measureCost(rig, input);
+
+                // the last fftSize samples, long after the detectors and filters settled
+                juce::AudioBuffer<float> output(rig.getNumChannels(), input.getNumSamples());
+                rig.render(input, output);
+                const double aliasing = measureAliasing(output.getReadPointer(0, input.getNumSamples() - (1 << fftOrder)),
+                                                        fftOrder, fundamentalBin);
+
+                std::printf("%8s  %5dx  %5s  %12.1f  %12.1f\n", curves[curve], 1 << factorIndex, adaa ? "on" : "off",
+                            cost, aliasing);
+            }
+        }
+    }
+}
+
+
+//==============================================================================
+// TANH: the rational against std::tanh over the whole float line, then over what the shapers feed it (drive * x,
+// drive 1 to 7 from getDistortionSettings, |x| up to 1) with what a sample costs each way
+static double getTanhError(float x)
+{
+    return std::abs((double) fastTanh::tanh(x) - std::tanh((double) x));
+}
+
+
+static volatile float tanhSink = 0.0f;
+
+// ns per sample of process(in, out, n), the fastest of five passes over the block
+template <typename Process>
+static double measureTanhCost(Process&& process, const float* in, float* out, int numSamples)
+{
+    constexpr int repeats = 200;
+    double best = std::numeric_limits<double>::max();
+
+    for (int pass = 0; pass < 5; ++pass)
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        for (int r = 0; r < repeats; ++r)
+            process(in, out, numSamples);
+
+        best = juce::jmin(best, juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks));
+
+        tanhSink = out[numSamples / 2]; // keeps the loops from being optimised away
+    }
+
+    return best * 1.0e9 / ((double) repeats * numSamples);
+}
+
+
+static void benchmarkTanh()
+{
+    using Vec = juce::dsp::SIMDRegister<float>;
+
+    printHeader("fastTanh vs std::tanh");
+
+   #if LABEURRE_EXACT_TANH
+    std::printf("built with LABEURRE_EXACT_TANH, fastTanh::tanh is std::tanh here\n\n");
+   #endif
+
+    double worst = 0.0;
+    float worstX = 0.0f;
+
+    for (int i = -6000000; i <= 6000000; ++i)
+    {
+        const float x = (float) (i * 1.0e-5);
+        const double error = getTanhError(x);
+
+        if (error > worst)
+        {
+            worst = error;
+            worstX = x;
+        }
+    }
+
+    std::printf("[-60, 60] in 1e-5 steps: max abs error %.3g at x = %.5f\n\n", worst, worstX);
+
+    constexpr int numSamples = 4096;
+    alignas(Vec::SIMDRegisterSize) float in[numSamples];
+    alignas(Vec::SIMDRegisterSize) float out[numSamples];
+    juce::Random random(0x1abe);
+
+    for (auto& x : in)
+        x = 2.0f * random.nextFloat() - 1.0f;
+
+    std::printf("%6s  %14s  %12s  %12s  %12s\n", "drive", "max abs error", "std ns/smp", "fast ns/smp", "SIMD ns/smp");
+
+    for (float drive = 1.0f; drive <= 7.0f; drive += 1.0f)
+    {
+        double driveWorst = 0.0;
+
+        for (int i = -1000000; i <= 1000000; ++i)
+            driveWorst = juce::jmax(driveWorst, getTanhError(drive * (float) (i * 1.0e-6)));
+
+        const double exact = measureTanhCost([drive] (const float* x, float* y, int n)
+        {
+            for (int i = 0; i < n; ++i)
+                y[i] = std::tanh(drive * x[i]);
+        }, in, out, numSamples);
+
+        const double fast = measureTanhCost([drive] (const float* x, float* y, int n)
+        {
+            for (int i = 0; i < n; ++i)
+                y[i] = fastTanh::tanh(drive * x[i]);
+        }, in, out, numSamples);
+
+        const double simd = measureTanhCost([drive] (const float* x, float* y, int n)
+        {
+            for (int i = 0; i < n; i += (int) Vec::SIMDNumElements)
+                fastTanh::tanh(Vec::fromRawArray(x + i) * drive).copyToRawArray(y + i);
+        }, in, out, numSamples);
+
+        std::printf("%6.1f  %14.3g  %12.2f  %12.2f  %12.2f\n", drive, driveWorst, exact, fast, simd);
+    }
+}
+
+
+//==============================================================================
+// MODES: every distortion type x compressor mode the kernel has an instantiation for, one row each. "off" is GLUE
+// with both compressor knobs at zero, which the kernel runs without its detectors. The band engine runs the same two
+// bands on a mono channel (a pair would go to the kernel), so both columns are per channel for the same work
+static void benchmarkModes()
+{
+    constexpr double sampleRate = 48000.0;
+
+    printHeader("Distortion type x compressor mode (two bands, 48 kHz, 512 sample blocks)");
+    std::printf("%8s  %6s  %18s  %18s\n", "curve", "comp", "kernel ns/smp", "band engine ns/smp");
+
+    const auto input = makeProgramme(2, sampleRate, 1.0);
+    const char* curves[] = { "WARM", "CRUSH", "DON'T" };
+    const char* modes[] = { "GLUE", "TAME", "OTT", "off" };
+
+    for (int curve = 0; curve < 3; ++curve)
+    {
+        for (int mode = 0; mode < 4; ++mode)
+        {
+            const float intensity = mode == 3 ? 0.0f : 0.6f;
+
+            const Rig::Parameters parameters { { "numBands", 2.0f }, { "distortionType", 0.5f * curve },
+                                               { "compressorSpeed", mode == 3 ? 0.0f : 0.5f * mode },
+                                               { "compLowIntensity", intensity }, { "compHighIntensity", intensity },
+                                               { "distLowIntensity", 0.6f }, { "distHighIntensity", 0.6f } };
+
+            Rig kernel(juce::AudioChannelSet::stereo(), sampleRate, 512, parameters);
+            Rig bandEngine(juce::AudioChannelSet::mono(), sampleRate, 512, parameters);
+
+            std::printf("%8s  %6s  %18.1f  %18.1f\n", curves[curve], modes[mode],
+                        measureCost(kernel, input), measureCost(bandEngine, input));
+        }
+    }
+}
+
+
+//==============================================================================
+// CONTROL RATE: both compressors (OTT) with their gains recomputed every 1, 8, 16 or 32 samples. Cost, and how far
+// the output lands from the every-sample render of the same input from a fresh processor (max and RMS, dBFS)
+static void benchmarkControlRate()
+{
+    constexpr double sampleRate = 48000.0;
+    const int intervals[] = { 1, 8, 16, 32 };
+
+    printHeader("Compressor control interval: CPU vs accuracy (OTT, stereo, 48 kHz, 512 sample blocks)");
+    std::printf("%12s  %8s  %10s  %14s  %14s\n", "path", "interval", "ns/smp", "max diff dBFS", "RMS diff dBFS");
+
+    const auto input = makeProgramme(2, sampleRate, 2.0);
+
+    for (int numBands : { 2, 3 })
+    {
+        juce::AudioBuffer<float> reference;
+
+        for (int index = 0; index < 4; ++index)
+        {
+            Rig rig(juce::AudioChannelSet::stereo(), sampleRate, 512,
+                    { { "numBands", (float) numBands }, { "compressorSpeed", 1.0f }, { "compLowIntensity", 0.8f },
+                      { "compHighIntensity", 0.8f }, { "distLowIntensity", 0.0f }, { "distHighIntensity", 0.0f },
+                      { "compressorControlRate", (float) index } });
+
+            // first thing the fresh processor does, so every interval starts from the same state
+            juce::AudioBuffer<float> output(rig.getNumChannels(), input.getNumSamples());
+            rig.render(input, output);
+
+            if (index == 0)
+                reference.makeCopyOf(output);
+
+            double maxDifference = 0.0, sumOfSquares = 0.0;
+
+            for (int channel = 0; channel < output.getNumChannels(); ++channel)
+            {
+                for (int i = 0; i < output.getNumSamples(); ++i)
+                {
+                    const double difference = (double) output.getSample(channel, i) - reference.getSample(channel, i);
+                    maxDifference = juce::jmax(maxDifference, std::abs(difference));
+                    sumOfSquares += difference * difference;
+                }
+            }
+
+            const double rms = std::sqrt(sumOfSquares / ((double) output.getNumChannels() * output.getNumSamples()));
+
+            std::printf("%12s  %8d  %10.1f  %14.1f  %14.1f\n", numBands == 2 ? "kernel" : "band engine", intervals[index],
+                        measureCost(rig, input), juce::Decibels::gainToDecibels(maxDifference, -200.0),
+                        juce::Decibels::gainToDecibels(rms, -200.0));
+        }
+    }
+}
+
+
+//==============================================================================
+// CROSSOVER: what the minimum phase paths cost against the partitioned FFT convolution, at the host block
+// sizes that matter. One sample blocks are the per-sample extreme: everything the chain does once per call
+static void benchmarkCrossover()
+{
+    constexpr double sampleRate = 48000.0;
+
+    printHeader("Minimum vs linear phase crossover, ns per sample (stereo, 48 kHz)");
+    std::printf("%6s  %16s  %16s  %16s  %16s\n", "block", "min 2 (kernel)", "min 3 bands", "linear 2 bands", "linear 3 bands");
+
+    const auto input = makeProgramme(2, sampleRate, 1.0);
+
+    for (int blockSize : { 1, 64, 256, 1024 })
+    {
+        std::printf("%6d", blockSize);
+
+        for (float crossoverMode : { 0.0f, 1.0f })
+        {
+            for (int numBands : { 2, 3 })
+            {
+                Rig rig(juce::AudioChannelSet::stereo(), sampleRate, blockSize,
+                        { { "numBands", (float) numBands }, { "crossoverMode", crossoverMode } });
+
+                std::printf("  %16.1f", measureCost(rig, input));
+            }
+        }
+
+        std::printf("\n");
+    }
+}
+
+
+//==============================================================================
+// PRECISION: the whole chain as a float host runs it and as a double one does (Engine<double>, the kernel on two
+// 2-lane registers). Cost per channel, and how far the double render lands from the float one from a fresh processor.
+// The shaper tables, fastTanh and the linear phase FFT are float in both, the rest runs at the host's precision
+static void benchmarkPrecision()
+{
+    constexpr double sampleRate = 48000.0;
+
+    printHeader("Float vs double precision processing (stereo, 48 kHz, 512 sample blocks)");
+    std::printf("%22s  %12s  %13s  %8s  %14s\n", "path", "float ns/smp", "double ns/smp", "ratio", "max diff dBFS");
+
+    const auto input = makeProgramme(2, sampleRate, 1.0);
+
+    const std::pair<const char*, Rig::Parameters> paths[] =
+    {
+        { "kernel, 2 bands",      { { "numBands", 2.0f } } },
+        { "kernel, OTT + ADAA",   { { "numBands", 2.0f }, { "compressorSpeed", 1.0f }, { "distortionADAA", 1.0f } } },
+        { "kernel, 4x",           { { "numBands", 2.0f }, { "oversampling", 2.0f } } },
+        { "band engine, 3 bands", { { "numBands", 3.0f } } },
+        { "linear phase, 3 bands", { { "numBands", 3.0f }, { "crossoverMode", 1.0f } } }
+    };
+
+    for (const auto& [name, parameters] : paths)
+    {
+        Rig single(juce::AudioChannelSet::stereo(), sampleRate, 512, parameters);
+        Rig dual(juce::AudioChannelSet::stereo(), sampleRate, 512, parameters, juce::AudioProcessor::doublePrecision);
+
+        // first thing either processor does, so both start from the same state
+        juce::AudioBuffer<float> floatOutput(2, input.getNumSamples());
+        juce::AudioBuffer<double> doubleOutput(2, input.getNumSamples());
+        single.render(input, floatOutput);
+        dual.render(input, doubleOutput);
+
+        double maxDifference = 0.0;
+
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < input.getNumSamples(); ++i)
+                maxDifference = juce::jmax(maxDifference, std::abs(doubleOutput.getSample(channel, i) - floatOutput.getSample(channel, i)));
+
+        const double floatCost = measureCost<float>(single, input);
+        const double doubleCost = measureCost<double>(dual, input);
+
+        std::printf("%22s  %12.1f  %13.1f  %7.2fx  %14.1f\n", name, floatCost, doubleCost, doubleCost / floatCost,
+                    juce::Decibels::gainToDecibels(maxDifference, -200.0));
+    }
+}
+
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    // the processor posts to the message thread (latency changes) and shares its worker threads
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const std::pair<const char*, void (*)()> sections[] =
+    {
+        { "kernel",    benchmarkKernel },
+        { "adaa",      benchmarkAntiAliasing },
+        { "tanh",      benchmarkTanh },
+        { "modes",     benchmarkModes },
+        { "control",   benchmarkControlRate },
+        { "crossover", benchmarkCrossover },
+        { "precision", benchmarkPrecision }
+    };
+
+    juce::StringArray requested;
+
+    for (int i = 1; i < argc; ++i)
+        requested.add(argv[i]);
+
+   #if JUCE_DEBUG
+    std::printf("debug build, the timings below mean nothing\n");
+   #endif
+
+    for (const auto& [name, run] : sections)
+        if (requested.isEmpty() || requested.contains(name))
+            run();
+
+    return 0;
+}
@@ -47,6 +47,7 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcess
     
   
     startTimerHz(80);
+    audioProcessor.setAnalyserActive(true);
    
     
 
@@ -141,6 +142,8 @@ SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcess
 
 SimpleEQAudioProcessorEditor::~SimpleEQAudioProcessorEditor()
 {
+    audioProcessor.setAnalyserActive(false);
+    
     audioProcessor.apvts.removeParameterListener("bandsplit_frequency", this);
     audioProcessor.apvts.removeParameterListener("distHighIntensity", this);
     audioProcessor.apvts.removeParameterListener("distLowIntensity", this);
@@ -231,7 +234,8 @@ void SimpleEQAudioProcessorEditor::timerCallback()
 //    freqLine.updateYFromHerz();
 
 
-    visualizer.setFFTData(audioProcessor.getFftData());
+    if (auto* frame = audioProcessor.getFftData())
+        visualizer.setFFTData(*frame);
     
 
 }
@@ -54,8 +54,6 @@ private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     
-    std::vector<float> fftBins;
-
     juce::Image bg_image;
     
     juce::MouseCursor normalCursor;
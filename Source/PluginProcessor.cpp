@@ -9,6 +9,14 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+static constexpr const char* parameterIDs[] = { "bandsplit_frequency", "compLowIntensity", "compHighIntensity", "compressorSpeed",
+                                                "distLowIntensity", "distHighIntensity", "distortionType", "highCutFreq",
+                                                "oversampling", "oversamplingFilter", "distortionADAA", "compressorControlRate",
+                                                "numBands", "bandsplit_frequency_2", "bandsplit_frequency_3", "bandsplit_frequency_4",
+                                                "crossoverMode", "stereoMode", "compLowIntensitySide", "compHighIntensitySide",
+                                                "distLowIntensitySide", "distHighIntensitySide", "stereoLink", "lookahead",
+                                                "truePeakCeiling", "ceiling", "externalSidechain", "mix" };
+
 //==============================================================================
 SimpleEQAudioProcessor::SimpleEQAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -16,16 +24,29 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        )
 #endif
 {
+    parameters.resolve(apvts);
+    
+    for (auto* id : parameterIDs)
+        apvts.addParameterListener(id, this);
+
+    startTimerHz(latencyPollHz);
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    stopTimer();
+    setAnalyserActive(false);
+    kernelBuilderThread->removeTimeSliceClient(&linearCrossover);
+    
+    for (auto* id : parameterIDs)
+        apvts.removeParameterListener(id, this);
 }
 
 //==============================================================================
@@ -63,7 +84,7 @@ bool SimpleEQAudioProcessor::isMidiEffect() const
 
 double SimpleEQAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailSeconds.load(std::memory_order_relaxed);
 }
 
 int SimpleEQAudioProcessor::getNumPrograms()
@@ -94,26 +115,189 @@ void SimpleEQAudioProcessor::changeProgramName (int index, const juce::String& n
 // PREPARE TO PLAY
 //==============================================================================
 
+// left / right partners of a layout, only these ever get their detectors linked
+static juce::AudioChannelSet::ChannelType getLinkPartner(juce::AudioChannelSet::ChannelType type)
+{
+    using Set = juce::AudioChannelSet;
+
+    static constexpr std::pair<Set::ChannelType, Set::ChannelType> partners[] =
+    {
+        { Set::left,              Set::right },
+        { Set::leftSurround,      Set::rightSurround },
+        { Set::leftSurroundSide,  Set::rightSurroundSide },
+        { Set::leftSurroundRear,  Set::rightSurroundRear },
+        { Set::leftCentre,        Set::rightCentre },
+        { Set::wideLeft,          Set::wideRight },
+        { Set::topFrontLeft,      Set::topFrontRight },
+        { Set::topSideLeft,       Set::topSideRight },
+        { Set::topRearLeft,       Set::topRearRight }
+    };
+
+    for (const auto& [left, right] : partners)
+    {
+        if (type == left)  return right;
+        if (type == right) return left;
+    }
+
+    return Set::unknown;
+}
+
+
+std::vector<SimpleEQAudioProcessor::ChannelGroup> SimpleEQAudioProcessor::getChannelGroups(const juce::AudioChannelSet& layout, int numChannels)
+{
+    std::vector<ChannelGroup> groups;
+    std::vector<int> unpaired;
+    std::vector<bool> grouped((size_t) numChannels, false);
+
+    // a layout that doesn't describe the buffer has no pairs to trust
+    const bool typed = layout.size() == numChannels;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        if (grouped[(size_t) channel])
+            continue;
+
+        const auto partnerType = typed ? getLinkPartner(layout.getTypeOfChannel(channel)) : juce::AudioChannelSet::unknown;
+        const int partner = partnerType != juce::AudioChannelSet::unknown ? layout.getChannelIndexForType(partnerType) : -1;
+
+        if (partner > channel && ! grouped[(size_t) partner])
+        {
+            groups.push_back({ { channel, partner }, 2, true });
+            grouped[(size_t) partner] = true;
+        }
+        else
+        {
+            unpaired.push_back(channel);
+        }
+    }
+
+    // the rest run two by two all the same, just never linked
+    for (size_t i = 0; i < unpaired.size(); i += 2)
+    {
+        if (i + 1 < unpaired.size())
+            groups.push_back({ { unpaired[i], unpaired[i + 1] }, 2, false });
+        else
+            groups.push_back({ { unpaired[i], -1 }, 1, false });
+    }
+
+    return groups;
+}
+
+
 void SimpleEQAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
+    // one chain per channel of the main buses, a kernel per group of two
+    const int numChannels = juce::jmax(getMainBusNumInputChannels(), getMainBusNumOutputChannels());
+
+    channelGroups = getChannelGroups(getChannelLayoutOfBus(false, 0), numChannels);
+    fftData.setSampleRate(sampleRate);
+
+    // the builder can't be touching the kernel sets while they're reallocated
+    kernelBuilderThread->removeTimeSliceClient(&linearCrossover);
+    linearCrossover.prepare(sampleRate, numChannels + maxSidechainChannels);
+
+    // the host has picked the precision by now, only that engine gets prepared
+    if (isUsingDoublePrecision())
+    {
+        floatEngine.release();
+        prepare<double>(sampleRate, samplesPerBlock, numChannels);
+    }
+    else
+    {
+        doubleEngine.release();
+        prepare<float>(sampleRate, samplesPerBlock, numChannels);
+    }
+
+    // the host reads it as soon as prepareToPlay returns, don't wait for the timer
+    setLatencySamples(reportedLatency.load());
+
+    // first kernels right here, the builder thread only follows the changes from now on
+    linearCrossover.buildPendingKernels();
+    kernelBuilderThread->addTimeSliceClient(&linearCrossover);
+}
+
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::prepare(double sampleRate, int samplesPerBlock, int numChannels)
+{
+    auto& engine = getEngine<SampleType>();
+    auto& channelChains = engine.channelChains;
+    auto& stereoKernels = engine.stereoKernels;
 
+    // every band processor only ever sees one channel of one band buffer
     juce::dsp::ProcessSpec spec;
     spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = getTotalNumOutputChannels();
+    spec.numChannels = 1;
     spec.sampleRate = sampleRate;
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
-    fftData.setSampleRate(sampleRate);
+    // contiguous, the block loops walk the chains in channel order
+    channelChains.resize((size_t) numChannels);
+
+    const int numPairs = (int) std::count_if(channelGroups.begin(), channelGroups.end(),
+                                             [] (const ChannelGroup& group) { return group.numChannels == 2; });
 
-    float crossoverFreq = apvts.getRawParameterValue("bandsplit_frequency")->load();
+    while (stereoKernels.size() < numPairs)
+        stereoKernels.add(new SIMDMultiBandKernel<SampleType>());
 
-    leftChain.get<0>().setCutoffFrequency(crossoverFreq);
-    rightChain.get<0>().setCutoffFrequency(crossoverFreq);
+    while (stereoKernels.size() > numPairs)
+        stereoKernels.removeLast();
 
-    updateFilter();
-    updateCompressor();
+    engine.crossover.prepare(sampleRate, numChannels + maxSidechainChannels);
 
+    engine.bandBuffer.setSize(2 * maxBands, samplesPerBlock); // the bands of a channel pair
+    engine.sidechainBands.setSize(maxSidechainChannels * maxBands, samplesPerBlock);
+
+    for (auto& chain : channelChains)
+    {
+        for (auto& compressor : chain.compressors)
+            compressor.prepare(spec);
+
+        for (auto& upward : chain.upwardCompressors)
+            upward.prepare(sampleRate);
+
+        for (auto& state : chain.distortionStates)
+            state.reset();
+
+        chain.oversampler.prepare(maxBands, samplesPerBlock);
+
+        // the high cut gets its biquad storage here, updateFilter only rewrites it in place afterwards
+        chain.highCut.coefficients = juce::dsp::IIR::Coefficients<SampleType>::makeLowPass(sampleRate, (SampleType) 20000);
+        chain.highCut.reset();
+    }
+
+    for (auto* kernel : stereoKernels)
+        kernel->prepare(sampleRate, samplesPerBlock);
+
+    engine.truePeakLimiter.prepare(sampleRate, numChannels);
+    ceilingActive = false;
+
+    // room for the longest latency any setting can give, so moving them never reallocates (the ceiling's for bypass)
+    const int maxLatency = LinearPhaseCrossover::latencySamples
+                         + (channelChains.empty() ? 0 : channelChains.front().oversampler.getMaxLatencySamples())
+                         + (int) std::ceil(DownwardCompressor<SampleType>::maxLookaheadMs * 0.001 * sampleRate)
+                         + maxAntiAliasingLatency
+                         + engine.truePeakLimiter.getLatencySamples();
+
+    engine.dryWet.prepare(sampleRate, numChannels, samplesPerBlock, maxLatency);
+    engine.keyDelay.prepare(maxSidechainChannels, (channelChains.empty() ? 0 : channelChains.front().oversampler.getMaxLatencySamples())
+                                                  + maxAntiAliasingLatency);
+
+    silentSamples = 0;
+    idle = false;
+    chainStale = false;
+    primingSamples = 0;
+
+    // everything depends on the sample rate, so recompute it all now
+    dirtyFlags = 0;
+    const ChainSettings settings = parameters.load();
+
+    updateCrossover<SampleType>(settings);
+    updateFilter<SampleType>(settings);
+    updateCompressor<SampleType>(settings);
+    updateDistortion<SampleType>(settings);
+    updateOversampling<SampleType>(settings);
+    updateLimiter<SampleType>(settings);
+    updateLatency<SampleType>(settings);
 }
 
 
@@ -123,6 +307,7 @@ void SimpleEQAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    kernelBuilderThread->removeTimeSliceClient(&linearCrossover);
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -133,17 +318,32 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     return true;
   #else
     // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
+    // Mono, stereo, 5.1 / 7.1 stems and 1st to 3rd order ambisonics, every channel gets the same chain.
     // Some plugin hosts, such as certain GarageBand versions, will only
     // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    const auto& output = layouts.getMainOutputChannelSet();
+    const int ambisonicOrder = output.getAmbisonicOrder();
+
+    if (output != juce::AudioChannelSet::mono()
+     && output != juce::AudioChannelSet::stereo()
+     && output != juce::AudioChannelSet::create5point1()
+     && output != juce::AudioChannelSet::create7point1()
+     && ! (ambisonicOrder >= 1 && ambisonicOrder <= 3))
         return false;
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // the sidechain is optional, mono or stereo
+    if (layouts.inputBuses.size() > 1)
+    {
+        const auto& sidechain = layouts.getChannelSet(true, 1);
+
+        if (! sidechain.isDisabled() && sidechain != juce::AudioChannelSet::mono() && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
    #endif
 
     return true;
@@ -156,96 +356,494 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 // PROCESS BLOCK
 //==============================================================================
 
-void SimpleEQAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+// M = (L + R) / 2, S = (L - R) / 2
+template <typename SampleType>
+static void encodeMidSideInPlace(SampleType* left, SampleType* right, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const SampleType l = left[i], r = right[i];
+        left[i]  = (SampleType) 0.5 * (l + r);
+        right[i] = (SampleType) 0.5 * (l - r);
+    }
+}
+
+
+// L = M + S, R = M - S
+template <typename SampleType>
+static void decodeMidSideInPlace(SampleType* mid, SampleType* side, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const SampleType m = mid[i], s = side[i];
+        mid[i]  = m + s;
+        side[i] = m - s;
+    }
+}
+
+
+// largest absolute sample over the first numChannels channels
+template <typename SampleType>
+static float getPeakMagnitude(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int numSamples)
+{
+    float peak = 0.0f;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        peak = juce::jmax(peak, (float) buffer.getMagnitude(channel, 0, numSamples));
+
+    return peak;
+}
+
+
+void SimpleEQAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    process(buffer, false);
+}
+
+
+// The host calls this instead of processBlock while it bypasses us: same path, faded over to the delayed dry
+void SimpleEQAudioProcessor::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    process(buffer, true);
+}
+
+
+bool SimpleEQAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+
+void SimpleEQAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    process(buffer, false);
+}
+
+
+void SimpleEQAudioProcessor::processBlockBypassed(juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    process(buffer, true);
+}
+
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::process(juce::AudioBuffer<SampleType>& buffer, bool bypassed)
 {
     juce::ScopedNoDenormals noDenormals;
+    auto& engine = getEngine<SampleType>();
+
+    // called before prepareToPlay (or prepared for the other precision): nothing is sized yet, the flags wait
+    if (engine.bandBuffer.getNumSamples() == 0 || engine.channelChains.empty())
+    {
+        buffer.clear();
+        return;
+    }
+
+    // take the dirty bits before the snapshot, a change landing in between just marks the next block
+    const auto dirty = dirtyFlags.exchange(0);
+
+    // one snapshot per block, every stage below reads from this
+    const ChainSettings settings = parameters.load();
 
-    updateCompressor();
-    updateFilter();
+    if (dirty & compressorDirty)  updateCompressor<SampleType>(settings);
+    if (dirty & filterDirty)      updateFilter<SampleType>(settings);
+    if (dirty & crossoverDirty)   updateCrossover<SampleType>(settings);
+    if (dirty & distortionDirty)  updateDistortion<SampleType>(settings);
+    if (dirty & oversamplingDirty) updateOversampling<SampleType>(settings);
+    if (dirty & limiterDirty)     updateLimiter<SampleType>(settings);
+    if (dirty & latencyDirty)     updateLatency<SampleType>(settings); // last, it reads what the others just set
+
+    engine.dryWet.setMix(settings.mix); // smoothed inside, it can just follow the snapshot
     
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
-    float distHigh = apvts.getRawParameterValue("distHighIntensity")->load();
-    float distLow = apvts.getRawParameterValue("distLowIntensity")->load();
-    int compSpeed = getCompressorSpeedMode();
+    // Clear unused output channels
+    for (int i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+        buffer.clear(i, 0, buffer.getNumSamples());
 
-    distortionSettings highSettings = getDistortionSettings(distHigh);
-    distortionSettings lowSettings = getDistortionSettings(distLow);
+    // hosts may hand us more than samplesPerBlock, everything below is sized for that much
+    const int maxChunk = engine.bandBuffer.getNumSamples();
 
-    float crossoverFreq = apvts.getRawParameterValue("bandsplit_frequency")->load();
+    if (buffer.getNumSamples() <= maxChunk)
+    {
+        processChunk(buffer, settings, bypassed);
+        return;
+    }
 
-    // Update crossover if needed
-    static float lastFreq = -1.0f;
-    if (std::abs(lastFreq - crossoverFreq) > 0.01f)
+    for (int start = 0; start < buffer.getNumSamples(); start += maxChunk)
     {
-        DBG("🔀 Band Split Frequency updated: " << crossoverFreq << " Hz");
-        lastFreq = crossoverFreq;
+        // refers to the host's channels, no copy (and no allocation up to 32 channels)
+        juce::AudioBuffer<SampleType> chunk(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start,
+                                            juce::jmin(maxChunk, buffer.getNumSamples() - start));
+        processChunk(chunk, settings, bypassed);
     }
+}
 
-    leftChain.get<0>().setCutoffFrequency(crossoverFreq);
-    rightChain.get<0>().setCutoffFrequency(crossoverFreq);
 
-    // Clear unused output channels
-    for (int i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear(i, 0, buffer.getNumSamples());
+template <typename SampleType>
+void SimpleEQAudioProcessor::processChunk(juce::AudioBuffer<SampleType>& buffer, const ChainSettings& settings, bool bypassed)
+{
+    auto& engine = getEngine<SampleType>();
+    auto& dryWet = engine.dryWet;
+    auto& truePeakLimiter = engine.truePeakLimiter;
+    auto& stereoKernels = engine.stereoKernels;
+
+    const int numChannels = juce::jmin(buffer.getNumChannels(), (int) engine.channelChains.size());
+    const int numSamples = buffer.getNumSamples();
+    const int ceilingLatency = ceilingActive ? truePeakLimiter.getLatencySamples() : 0;
+    int firstScalarGroup = 0;
+
+    // === DRY: into its delay line before anything touches the buffer ===
+    dryWet.pushDry(buffer.getArrayOfReadPointers(), numChannels, numSamples);
+
+    // === BYPASS: fade out with the chain running, skip it once the fade is done ===
+    if (bypassed)
+    {
+        dryWet.setBypassed(true);
+        primingSamples = 0;
+    }
+    else if (! chainStale && primingSamples <= 0)
+    {
+        dryWet.setBypassed(false);
+    }
 
-    // === PROCESS PER CHANNEL ===
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    if (dryWet.isBypassed())
     {
-        auto* channelData = buffer.getWritePointer(channel);
-        auto& chain = (channel == 0) ? leftChain : rightChain;
+        if (bypassed)
+        {
+            dryWet.fadeBypass(buffer.getArrayOfWritePointers(), numChannels, numSamples, ceilingLatency);
+            fftData.pushSamples(buffer.getReadPointer(0), numSamples);
+            chainStale = true;
+            return;
+        }
+
+        // back again: whatever the chain held is from before the bypass, start clean and stay dry while it fills up
+        if (chainStale)
+        {
+            resetChain<SampleType>();
+            chainStale = false;
+            primingSamples = tailSamples;
+            silentSamples = 0;
+            idle = false;
+        }
+    }
 
-        float y_old_low = 0.f;
-        float y_old_high = 0.f;
+    // === IDLE: silence in, and the chain has nothing left to give, so silence out ===
+    const float silenceThreshold = juce::Decibels::decibelsToGain(silenceThresholdDB);
+    const float inputPeak = getPeakMagnitude(buffer, numChannels, numSamples);
 
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+    if (idle)
+    {
+        if (inputPeak <= silenceThreshold)
         {
-            float inputSample = channelData[sample];
+            for (int channel = 0; channel < numChannels; ++channel)
+                buffer.clear(channel, 0, numSamples);
 
-            float lowSample, highSample;
-            chain.get<0>().processSample(channel, inputSample, lowSample, highSample);
+            dryWet.skip(numSamples);
+            return;
+        }
 
-            // Distortion
-            lowSample = distortionSample(lowSample, y_old_low, lowSettings.drive, lowSettings.c);
-            highSample = distortionSample(highSample, y_old_high, highSettings.drive, highSettings.c);
+        idle = false;
+        silentSamples = 0;
+    }
 
-            y_old_low = lowSample;
-            y_old_high = highSample;
+    // === EXTERNAL SIDECHAIN: keys the downward detectors, band by band ===
+    const int numSidechainChannels = getNumSidechainChannels(settings);
+    SampleType* const* sidechainData = numSidechainChannels > 0 ? buffer.getArrayOfWritePointers() + getChannelIndexInProcessBlockBuffer(true, 1, 0)
+                                                                 : nullptr;
 
-            // Upward Compression (OTT)
-            if (compSpeed == 2)
-            {
-                std::tie(lowSample, highSample) = applyUpwardCompression(lowSample, highSample);
-            }
+    if (numSidechainChannels > 0)
+        engine.keyDelay.process(sidechainData, numSidechainChannels, numSamples);
 
-            // Downward Compression
-            lowSample = chain.get<1>().get<1>().processSample(channel, lowSample);
-            highSample = chain.get<2>().get<1>().processSample(channel, highSample);
+    // === TWO MINIMUM PHASE BANDS: SIMD KERNEL PER GROUP OF TWO ===
+    if (engine.crossover.getNumBands() == 2 && ! linearPhase)
+    {
+        for (int pair = 0; pair < stereoKernels.size(); ++pair)
+        {
+            const auto& group = channelGroups[(size_t) pair];
 
-            // Makeup Gain
-            lowSample = chain.get<1>().get<2>().processSample(lowSample);
-            highSample = chain.get<2>().get<2>().processSample(highSample);
+            // the kernel splits the key itself, next to the signal
+            const SampleType* keyLeft  = numSidechainChannels > 0 ? sidechainData[group.channels[0] % numSidechainChannels] : nullptr;
+            const SampleType* keyRight = numSidechainChannels > 0 ? sidechainData[group.channels[1] % numSidechainChannels] : nullptr;
 
-            // Final mix
-            float outputSample = lowSample + highSample;
-            outputSample = chain.get<3>().processSample(outputSample);
-            channelData[sample] = outputSample;
+            stereoKernels[pair]->process(buffer.getWritePointer(group.channels[0]), buffer.getWritePointer(group.channels[1]),
+                                         numSamples, keyLeft, keyRight);
         }
+
+        firstScalarGroup = stereoKernels.size();
     }
+    else if (linearPhase)
+    {
+        linearCrossover.beginBlock((int) engine.channelChains.size() + numSidechainChannels);
+    }
+
+    // the kernel does mid/side in its lane packing, the band engine needs the pair encoded up front (the key too)
+    const bool encodeMidSide = midSide && firstScalarGroup == 0 && numChannels >= 2;
+
+    if (encodeMidSide)
+    {
+        encodeMidSideInPlace(buffer.getWritePointer(0), buffer.getWritePointer(1), numSamples);
+
+        if (numSidechainChannels == 2)
+            encodeMidSideInPlace(sidechainData[0], sidechainData[1], numSamples);
+    }
+
+    // === EVERYTHING ELSE: BAND ENGINE, PER CHANNEL GROUP (the detectors of a layout pair can be linked) ===
+    if (firstScalarGroup < (int) channelGroups.size() && numSidechainChannels > 0)
+        splitSidechain(sidechainData, numSidechainChannels, numSamples);
 
-    // === FFT Processing (Once Per Block) ===
+    for (size_t group = (size_t) firstScalarGroup; group < channelGroups.size(); ++group)
+        processChannelGroup(buffer.getArrayOfWritePointers(), channelGroups[group], numSamples, numSidechainChannels, settings);
+
+    if (encodeMidSide)
+        decodeMidSideInPlace(buffer.getWritePointer(0), buffer.getWritePointer(1), numSamples);
+
+    // === DRY / WET: the delayed dry mixed in place ===
+    dryWet.mixWet(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+    // === TRUE PEAK CEILING: on the final mix, one gain for every channel ===
+    if (ceilingActive)
+        truePeakLimiter.process(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+    // === BYPASS FADE: to or from the dry, delayed by the whole chain ===
+    dryWet.fadeBypass(buffer.getArrayOfWritePointers(), numChannels, numSamples, ceilingLatency);
+    primingSamples = juce::jmax(0, primingSamples - numSamples);
+
+    // a chain that stayed silent for its whole tail (and the detectors' release) can stop until signal comes back
+    if (inputPeak <= silenceThreshold && ! bypassed && getPeakMagnitude(buffer, numChannels, numSamples) <= silenceThreshold)
+        silentSamples += numSamples;
+    else
+        silentSamples = 0;
+
+    idle = silentSamples >= tailSamples + juce::roundToInt(settleSeconds * getSampleRate());
+
+    // === FFT: only hand the samples over, the analyser thread does the rest ===
 
     // Use only left channel for spectrum analysis
-    juce::AudioBuffer<float> monoBuffer(1, buffer.getNumSamples());
-    monoBuffer.copyFrom(0, 0, buffer, 0, 0, buffer.getNumSamples());
-    fftData.pushSamples(monoBuffer);
+    fftData.pushSamples(buffer.getReadPointer(0), numSamples);
+}
+
+
+// only while it's switched on and the host actually feeds the bus
+int SimpleEQAudioProcessor::getNumSidechainChannels(const ChainSettings& settings) const
+{
+    if (! settings.externalSidechain || getBusCount(true) < 2)
+        return 0;
+
+    return juce::jmin(maxSidechainChannels, getChannelCountOfBus(true, 1));
+}
+
+
+// Same crossover as the signal, the sidechain's split state sits right after the main channels
+template <typename SampleType>
+void SimpleEQAudioProcessor::splitSidechain(SampleType* const* sidechainData, int numSidechainChannels, int numSamples)
+{
+    auto& engine = getEngine<SampleType>();
+    const int numBands = engine.crossover.getNumBands();
+    SampleType* const* keyBands = engine.sidechainBands.getArrayOfWritePointers();
+
+    for (int s = 0; s < numSidechainChannels; ++s)
+    {
+        const int splitChannel = (int) engine.channelChains.size() + s;
+
+        if (linearPhase)
+            linearCrossover.process(splitChannel, sidechainData[s], keyBands + s * maxBands, numBands, numSamples);
+        else
+            engine.crossover.process(splitChannel, sidechainData[s], keyBands + s * maxBands, numSamples);
+    }
+}
+
+
+void SimpleEQAudioProcessor::setAnalyserActive(bool shouldBeActive)
+{
+    if (shouldBeActive)
+    {
+        fftData.attach();
+        analyserThread->addTimeSliceClient(&fftData);
+    }
+    else
+    {
+        analyserThread->removeTimeSliceClient(&fftData);
+        fftData.detach();
+    }
+}
+
+
+
+
+// Runs every stage over a whole block instead of sample by sample:
+// split into the band buffers once, then each stage walks a contiguous array
+// One channel, or two whose compressors may be linked if they're a pair of the layout. The bands of group
+// channel c live in bandBuffer channels [c * maxBands, c * maxBands + numBands)
+template <typename SampleType>
+void SimpleEQAudioProcessor::processChannelGroup(SampleType* const* channelData, const ChannelGroup& group, int numSamples,
+                                                 int numSidechainChannels, const ChainSettings& settings)
+{
+    auto& engine = getEngine<SampleType>();
+    const int numBands = engine.crossover.getNumBands();
+    const int numGroupChannels = group.numChannels;
+    SampleType* const* bandData = engine.bandBuffer.getArrayOfWritePointers();
+
+    for (int c = 0; c < numGroupChannels; ++c)
+    {
+        const int channel = group.channels[c];
+        auto& chain = engine.channelChains[(size_t) channel];
+        SampleType* const* bands = bandData + c * maxBands;
+        SampleType* data = channelData[channel];
+
+        // Crossover
+        if (linearPhase)
+            linearCrossover.process(channel, data, bands, numBands, numSamples);
+        else
+            engine.crossover.process(channel, data, bands, numSamples);
+
+        // Distortion (all bands go up and down through the same oversampler)
+        auto bandBlock = juce::dsp::AudioBlock<SampleType>(engine.bandBuffer).getSubsetChannelBlock((size_t) (c * maxBands), (size_t) numBands)
+                                                                             .getSubBlock(0, (size_t) numSamples);
+        auto* os = chain.oversampler.getActive();
+        auto distortionBlock = os != nullptr ? os->processSamplesUp(bandBlock) : bandBlock;
+
+        // same envelope time whatever rate it runs at, as in the kernel
+        const float envelopeAlpha = DistortionState<SampleType>::envelopeAlpha / (float) chain.oversampler.getFactor();
+
+        switch (settings.distortionType)
+        {
+            case 0:  distortBands<0>(distortionBlock, chain.distortionStates, chain.distortion, settings.distortionADAA, envelopeAlpha); break;
+            case 1:  distortBands<1>(distortionBlock, chain.distortionStates, chain.distortion, settings.distortionADAA, envelopeAlpha); break;
+            default: distortBands<2>(distortionBlock, chain.distortionStates, chain.distortion, settings.distortionADAA, envelopeAlpha); break;
+        }
+
+        if (os != nullptr)
+            os->processSamplesDown(bandBlock);
+    }
+
+    // Upward Compression (OTT) + Downward Compression, the mode resolved here so the band loops never test it
+    switch (settings.compressorSpeed)
+    {
+        case 0:  compressBands<0, SampleType>(group, numSamples, numSidechainChannels, settings.stereoLink); break;
+        case 1:  compressBands<1, SampleType>(group, numSamples, numSidechainChannels, settings.stereoLink); break;
+        default: compressBands<2, SampleType>(group, numSamples, numSidechainChannels, settings.stereoLink); break;
+    }
+
+    for (int c = 0; c < numGroupChannels; ++c)
+    {
+        auto& chain = engine.channelChains[(size_t) group.channels[c]];
+        SampleType* const* bands = bandData + c * maxBands;
+        SampleType* data = channelData[group.channels[c]];
+
+        // Makeup Gain + Final mix, one pass per band
+        juce::FloatVectorOperations::copyWithMultiply(data, bands[0], chain.makeupGains[0], numSamples);
 
-    std::vector<float> newBins;
-    if (fftData.produceFFTData(newBins))
+        for (int band = 1; band < numBands; ++band)
+            juce::FloatVectorOperations::addWithMultiply(data, bands[band], chain.makeupGains[band], numSamples);
+
+        // High Cut
+
+        juce::dsp::AudioBlock<SampleType> outBlock(&data, 1, (size_t) numSamples);
+        chain.highCut.process(juce::dsp::ProcessContextReplacing<SampleType>(outBlock));
+    }
+}
+
+
+// one detector per band when the pair is linked, OTT (CompMode 2) puts the upward stage in front of the downward one
+template <int CompMode, typename SampleType>
+void SimpleEQAudioProcessor::compressBands(const ChannelGroup& group, int numSamples, int numSidechainChannels, float stereoLink)
+{
+    auto& engine = getEngine<SampleType>();
+    const int numBands = engine.crossover.getNumBands();
+    SampleType* const* bandData = engine.bandBuffer.getArrayOfWritePointers();
+    const SampleType* const* keyData = engine.sidechainBands.getArrayOfReadPointers();
+
+    // a mid/side pair has different knobs on each side, linking it would make no sense
+    const bool linked = group.linkable && stereoLink > 0.0f && ! (midSide && group.channels[0] == 0);
+
+    // what the downward detector of group channel c follows in a band: the band itself, or the same band of the sidechain
+    auto getKey = [&](int c, int band) -> const SampleType*
+    {
+        if (numSidechainChannels > 0)
+            return keyData[(group.channels[c] % numSidechainChannels) * maxBands + band];
+
+        return bandData[c * maxBands + band];
+    };
+
+    if (linked)
+    {
+        auto& left  = engine.channelChains[(size_t) group.channels[0]];
+        auto& right = engine.channelChains[(size_t) group.channels[1]];
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            SampleType* bandL = bandData[band];
+            SampleType* bandR = bandData[maxBands + band];
+
+            if constexpr (CompMode == 2)
+                left.upwardCompressors[band].processLinked(right.upwardCompressors[band], bandL, bandR, numSamples, stereoLink);
+
+            left.compressors[band].processLinked(right.compressors[band], bandL, bandR, getKey(0, band), getKey(1, band),
+                                                 numSamples, stereoLink);
+        }
+
+        return;
+    }
+
+    for (int c = 0; c < group.numChannels; ++c)
+    {
+        auto& chain = engine.channelChains[(size_t) group.channels[c]];
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            SampleType* data = bandData[c * maxBands + band];
+
+            if constexpr (CompMode == 2)
+                chain.upwardCompressors[band].process(data, numSamples);
+
+            chain.compressors[band].processKeyed(data, getKey(c, band), numSamples);
+        }
+    }
+}
+
+
+// a different band count is a different signal path, the band engine and the kernel both start again from silence
+template <typename SampleType>
+void SimpleEQAudioProcessor::resetChain()
+{
+    auto& engine = getEngine<SampleType>();
+
+    resetBands<SampleType>();
+    engine.crossover.reset();
+    linearCrossover.reset();
+
+    for (auto& chain : engine.channelChains)
+    {
+        chain.oversampler.reset();
+        chain.highCut.reset();
+    }
+
+    engine.truePeakLimiter.reset();
+    engine.keyDelay.reset();
+}
+
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::resetBands()
+{
+    auto& engine = getEngine<SampleType>();
+
+    for (auto& chain : engine.channelChains)
     {
-        fftBins = std::move(newBins);
+        for (auto& compressor : chain.compressors)
+            compressor.reset();
+
+        for (auto& upward : chain.upwardCompressors)
+            upward.reset();
+
+        for (auto& state : chain.distortionStates)
+            state.reset();
     }
+
+    for (auto* kernel : engine.stereoKernels)
+        kernel->reset();
 }
 
 
@@ -284,7 +882,8 @@ void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBy
     {
         apvts.replaceState(tree);
      
-        updateCompressor();
+        // picked up by the next processBlock
+        dirtyFlags = allDirty;
     }
 }
 
@@ -295,28 +894,103 @@ void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBy
 //=========================================================================================================
 
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+void ParameterPointers::resolve(juce::AudioProcessorValueTreeState& apvts)
+{
+    bandsplitFrequency = apvts.getRawParameterValue("bandsplit_frequency");
+    compLowIntensity   = apvts.getRawParameterValue("compLowIntensity");
+    compHighIntensity  = apvts.getRawParameterValue("compHighIntensity");
+    compressorSpeed    = apvts.getRawParameterValue("compressorSpeed");
+    distLowIntensity   = apvts.getRawParameterValue("distLowIntensity");
+    distHighIntensity  = apvts.getRawParameterValue("distHighIntensity");
+    distortionType     = apvts.getRawParameterValue("distortionType");
+    highCutFreq        = apvts.getRawParameterValue("highCutFreq");
+    oversamplingFactor = apvts.getRawParameterValue("oversampling");
+    oversamplingFilter = apvts.getRawParameterValue("oversamplingFilter");
+    distortionADAA     = apvts.getRawParameterValue("distortionADAA");
+    compressorControlRate = apvts.getRawParameterValue("compressorControlRate");
+    stereoLink            = apvts.getRawParameterValue("stereoLink");
+    lookahead             = apvts.getRawParameterValue("lookahead");
+    truePeakCeiling       = apvts.getRawParameterValue("truePeakCeiling");
+    ceiling               = apvts.getRawParameterValue("ceiling");
+    externalSidechain     = apvts.getRawParameterValue("externalSidechain");
+    mix                   = apvts.getRawParameterValue("mix");
+    numBands            = apvts.getRawParameterValue("numBands");
+    bandsplitFrequency2 = apvts.getRawParameterValue("bandsplit_frequency_2");
+    bandsplitFrequency3 = apvts.getRawParameterValue("bandsplit_frequency_3");
+    bandsplitFrequency4 = apvts.getRawParameterValue("bandsplit_frequency_4");
+    crossoverMode       = apvts.getRawParameterValue("crossoverMode");
+    stereoMode          = apvts.getRawParameterValue("stereoMode");
+    compLowIntensitySide  = apvts.getRawParameterValue("compLowIntensitySide");
+    compHighIntensitySide = apvts.getRawParameterValue("compHighIntensitySide");
+    distLowIntensitySide  = apvts.getRawParameterValue("distLowIntensitySide");
+    distHighIntensitySide = apvts.getRawParameterValue("distHighIntensitySide");
+}
+
+
+ChainSettings ParameterPointers::load() const
 {
     ChainSettings settings;
-    
-    settings.bandsplit_frequency = apvts.getRawParameterValue("bandsplit_frequency") ->load();
-    
-    settings.compHighIntensity = apvts.getRawParameterValue("compHighIntensity") ->load();
-    settings.compLowIntensity = apvts.getRawParameterValue("compLowIntensity") ->load();
-    
-    settings.distLowIntensity = apvts.getRawParameterValue("distLowIntensity") ->load();
-    settings.distHighIntensity = apvts.getRawParameterValue("distHighIntensity") ->load();
-    
-    settings.compressorSpeed = static_cast<int>(apvts.getRawParameterValue("compressorSpeed")->load());
-    settings.distortionType = static_cast<int>(apvts.getRawParameterValue("distortionType")->load());
 
-    settings.highCutFreq = static_cast<int>(apvts.getRawParameterValue("highCutFreq")->load());
+    settings.bandsplit_frequency = bandsplitFrequency->load();
+    settings.bandsplit_frequency_2 = bandsplitFrequency2->load();
+    settings.bandsplit_frequency_3 = bandsplitFrequency3->load();
+    settings.bandsplit_frequency_4 = bandsplitFrequency4->load();
+    settings.numBands = juce::jlimit(2, CrossoverTree<float>::maxBands, juce::roundToInt(numBands->load()));
+    settings.crossoverMode = static_cast<int>(crossoverMode->load());
+    settings.midSide = static_cast<int>(stereoMode->load()) == 1;
+
+    settings.compLowIntensitySide  = compLowIntensitySide->load();
+    settings.compHighIntensitySide = compHighIntensitySide->load();
+    settings.distLowIntensitySide  = distLowIntensitySide->load();
+    settings.distHighIntensitySide = distHighIntensitySide->load();
+
+    settings.compHighIntensity = compHighIntensity->load();
+    settings.compLowIntensity = compLowIntensity->load();
+
+    settings.distLowIntensity = distLowIntensity->load();
+    settings.distHighIntensity = distHighIntensity->load();
+
+    settings.compressorSpeed = getCompressorSpeedMode(compressorSpeed->load());
+    settings.distortionType = getDistortionType(distortionType->load());
+
+    settings.highCutFreq = static_cast<int>(highCutFreq->load());
+
+    settings.oversamplingFactor = static_cast<int>(oversamplingFactor->load());
+    settings.oversamplingFilter = static_cast<int>(oversamplingFilter->load());
+    settings.distortionADAA     = distortionADAA->load() > 0.5f;
+    settings.compressorControlInterval = getCompressorControlInterval(compressorControlRate->load());
+    settings.stereoLink = stereoLink->load();
+    settings.lookaheadMs = lookahead->load();
+    settings.truePeakCeiling = truePeakCeiling->load() > 0.5f;
+    settings.ceilingDB = ceiling->load();
+    settings.externalSidechain = externalSidechain->load() > 0.5f;
+    settings.mix = mix->load();
     return settings;
 }
 
 
 // COEFFICIENT SETTING HELPERS -----------------------------------------------
 
+// inner bands sit on a straight line between the low and high intensity knobs, with two bands that's just the knobs
+static float getBandIntensity(float lowIntensity, float highIntensity, int band, int numBands)
+{
+    return juce::jmap((float) band / (float) (numBands - 1), lowIntensity, highIntensity);
+}
+
+// the knobs one channel follows: the side of a mid/side pair has its own set, every other channel the main one
+struct ChannelIntensities
+{
+    float compLow, compHigh, distLow, distHigh;
+};
+
+static ChannelIntensities getChannelIntensities(const ChainSettings& settings, bool side)
+{
+    if (side)
+        return { settings.compLowIntensitySide, settings.compHighIntensitySide, settings.distLowIntensitySide, settings.distHighIntensitySide };
+
+    return { settings.compLowIntensity, settings.compHighIntensity, settings.distLowIntensity, settings.distHighIntensity };
+}
+
 // COMPRESSOR ----------
 
 CompressorSettings SimpleEQAudioProcessor::getCompressorSettings(const double intensity){
@@ -340,38 +1014,55 @@ CompressorSettings SimpleEQAudioProcessor::getCompressorSettings(const double in
 }
 
 
-int SimpleEQAudioProcessor::getCompressorSpeedMode()
+int getCompressorSpeedMode(float raw)
 {
-    float raw = apvts.getRawParameterValue("compressorSpeed")->load();
-
     if      (raw < 0.4f) return 0; // GLUE
     else if (raw < 0.6f) return 1; // TAME
     else                 return 2; // OTT
 }
 
 
-void SimpleEQAudioProcessor::applyCompressorSettings(juce::dsp::Compressor<float>& compressor, juce::dsp::Gain<float>& gain, const CompressorSettings& settings, int compressorSpeed)
+int getCompressorControlInterval(float raw)
 {
-    compressor.setThreshold(settings.threshold);
+    const int index = juce::jlimit(0, (int) std::size(DownwardCompressor<float>::controlIntervals) - 1, juce::roundToInt(raw));
+    return DownwardCompressor<float>::controlIntervals[index];
+}
+
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::applyCompressorSettings(DownwardCompressor<SampleType>& compressor, const CompressorSettings& settings,
+                                                     int compressorSpeed, int controlInterval)
+{
+    compressor.setThreshold(settings.threshold);
     compressor.setRatio(settings.ratio);
+    compressor.setControlInterval(controlInterval);
     
-    gain.setGainDecibels(settings.makeupGain);
+    auto [attack, release] = getCompressorTimes(compressorSpeed);
+
+    compressor.setAttack(attack);
+    compressor.setRelease(release);
     
+}
+
+
+std::pair<float, float> SimpleEQAudioProcessor::getCompressorTimes(int compressorSpeed)
+{
     float fastestAttack = 1000.0f / getSampleRate();
     
     // Attack & Release settings based on compressor speed (0 = Fast, 1 = Slow)
     const std::array<float, 3> attackTimes = {fastestAttack, 100.0f, fastestAttack};  // ms
     const std::array<float, 3> releaseTimes = {50.0f, 200.0f, 60.0f}; // ms
 
-    compressor.setAttack(attackTimes[compressorSpeed]);
-    compressor.setRelease(releaseTimes[compressorSpeed]);
-    
+    return { attackTimes[compressorSpeed], releaseTimes[compressorSpeed] };
 }
 
 
-void SimpleEQAudioProcessor::updateCompressor()
+template <typename SampleType>
+void SimpleEQAudioProcessor::updateCompressor(const ChainSettings& chainSettings)
 {
-    const ChainSettings chainSettings = getChainSettings(apvts);
+    auto& channelChains = getEngine<SampleType>().channelChains;
+    auto& stereoKernels = getEngine<SampleType>().stereoKernels;
+
 //
 //    // Get compressor float value from APVTS
 //    float compSpeedRaw = apvts.getRawParameterValue("compressorSpeed")->load();
@@ -382,33 +1073,301 @@ void SimpleEQAudioProcessor::updateCompressor()
 //    else if (compSpeedRaw < 0.6f) compSpeed = 1; // TAME
 //    else                          compSpeed = 2; // OTT
     
-    int compSpeed = getCompressorSpeedMode();
+    int compSpeed = chainSettings.compressorSpeed;
+
+    const int controlInterval = chainSettings.compressorControlInterval;
+
+    // Apply settings to every band of every channel (Compressor + Gain), OTT follows the same intensities
+    for (int channel = 0; channel < (int) channelChains.size(); ++channel)
+    {
+        auto& chain = channelChains[(size_t) channel];
+        const auto knobs = getChannelIntensities(chainSettings, chainSettings.midSide && channel == 1);
+
+        for (int band = 0; band < chainSettings.numBands; ++band)
+        {
+            const float intensity = getBandIntensity(knobs.compLow, knobs.compHigh, band, chainSettings.numBands);
+            const CompressorSettings bandSettings = getCompressorSettings(intensity);
+
+            applyCompressorSettings(chain.compressors[band], bandSettings, compSpeed, controlInterval);
+
+            chain.upwardCompressors[band].setSettings(getUpwardCompSettings(intensity));
+            chain.upwardCompressors[band].setControlInterval(controlInterval);
+
+            chain.makeupGains[band] = juce::Decibels::decibelsToGain((SampleType) bandSettings.makeupGain);
+        }
+    }
+
+    auto [attack, release] = getCompressorTimes(compSpeed);
+    const int lookahead = getLookaheadSamples(chainSettings);
+
+    for (auto& chain : channelChains)
+        for (auto& compressor : chain.compressors)
+            compressor.setLookahead(lookahead);
 
-    // Define compressor settings for both bands
-    CompressorSettings lowBandSettings = getCompressorSettings(chainSettings.compLowIntensity);
-    CompressorSettings highBandSettings = getCompressorSettings(chainSettings.compHighIntensity);
+    // kernel lanes are { A low, A high, B low, B high }, only the first pair can be mid/side
+    for (int pair = 0; pair < stereoKernels.size(); ++pair)
+    {
+        const auto a = getChannelIntensities(chainSettings, false);
+        const auto b = getChannelIntensities(chainSettings, chainSettings.midSide && pair == 0);
+
+        const CompressorSettings compressorLanes[] = { getCompressorSettings(a.compLow), getCompressorSettings(a.compHigh),
+                                                       getCompressorSettings(b.compLow), getCompressorSettings(b.compHigh) };
+        const UpwardCompressorSettings upwardLanes[] = { getUpwardCompSettings(a.compLow), getUpwardCompSettings(a.compHigh),
+                                                         getUpwardCompSettings(b.compLow), getUpwardCompSettings(b.compHigh) };
+
+        auto* kernel = stereoKernels.getUnchecked(pair);
+        kernel->setCompressorMode(compSpeed);
+        kernel->setControlInterval(controlInterval);
+        kernel->setCompressor(compressorLanes, attack, release);
+        kernel->setUpwardCompression(upwardLanes);
+        const bool linkable = channelGroups[(size_t) pair].linkable && ! (chainSettings.midSide && pair == 0);
+        kernel->setStereoLink(linkable ? chainSettings.stereoLink : 0.0f);
+        kernel->setLookahead(lookahead);
+    }
+}
 
-    // Apply settings to both stereo channels (Compressor + Gain)
-    applyCompressorSettings(leftChain.get<1>().get<1>(), leftChain.get<1>().get<2>(), lowBandSettings, compSpeed);  // Low-band
-    applyCompressorSettings(leftChain.get<2>().get<1>(), leftChain.get<2>().get<2>(), highBandSettings, compSpeed); // High-band
 
-    applyCompressorSettings(rightChain.get<1>().get<1>(), rightChain.get<1>().get<2>(), lowBandSettings, compSpeed); // Low-band
-    applyCompressorSettings(rightChain.get<2>().get<1>(), rightChain.get<2>().get<2>(), highBandSettings, compSpeed); // High-band
+// Same maths as IIR::Coefficients::makeLowPass (Q = 1/sqrt2), but written into an existing
+// biquad so nothing gets allocated on the audio thread
+template <typename SampleType>
+static void writeLowPassCoefficients(juce::dsp::IIR::Coefficients<SampleType>& coefficients, double sampleRate, float frequency)
+{
+    frequency = juce::jlimit(20.0f, (float) (sampleRate * 0.49), frequency);
+
+    const auto n        = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    const auto nSquared = n * n;
+    const auto invQ     = juce::MathConstants<double>::sqrt2;
+    const auto c1       = 1.0 / (1.0 + invQ * n + nSquared);
+
+    // raw layout of a normalised biquad: b0, b1, b2, a1, a2
+    auto* raw = coefficients.getRawCoefficients();
+    raw[0] = (SampleType) c1;
+    raw[1] = (SampleType) (c1 * 2.0);
+    raw[2] = (SampleType) c1;
+    raw[3] = (SampleType) (c1 * 2.0 * (1.0 - nSquared));
+    raw[4] = (SampleType) (c1 * (1.0 - invQ * n + nSquared));
 }
 
-void SimpleEQAudioProcessor::updateFilter()
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::updateFilter(const ChainSettings& chainSettings)
 {
-    float cutoff = apvts.getRawParameterValue("highCutFreq")->load();
-    auto coefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(getSampleRate(), cutoff);
+    auto& channelChains = getEngine<SampleType>().channelChains;
+
+    float cutoff = chainSettings.highCutFreq;
+
+    for (auto& chain : channelChains)
+        writeLowPassCoefficients(*chain.highCut.coefficients, getSampleRate(), cutoff);
+
+    if (channelChains.empty())
+        return;
 
-    *leftChain.get<3>().coefficients = *coefficients;
-    *rightChain.get<3>().coefficients = *coefficients;
+    for (auto* kernel : getEngine<SampleType>().stereoKernels)
+        kernel->setHighCut(*channelChains.front().highCut.coefficients);
     
     //DEBUGGING
     //DBG("HighCut: " << cutoff << " Hz");
 }
 
 
+template <typename SampleType>
+void SimpleEQAudioProcessor::updateCrossover(const ChainSettings& chainSettings)
+{
+    auto& engine = getEngine<SampleType>();
+    auto& crossover = engine.crossover;
+    auto& stereoKernels = engine.stereoKernels;
+
+    float crossoverFreq = chainSettings.bandsplit_frequency;
+
+    // the tree needs ascending splits, a split set below the one under it just sits on top of it
+    float frequencies[CrossoverTree<SampleType>::maxSplits] = { crossoverFreq, chainSettings.bandsplit_frequency_2,
+                                                                chainSettings.bandsplit_frequency_3, chainSettings.bandsplit_frequency_4 };
+
+    for (int split = 1; split < CrossoverTree<SampleType>::maxSplits; ++split)
+        frequencies[split] = juce::jmax(frequencies[split], frequencies[split - 1]);
+
+    // switching the topology or what the channels mean starts the bands from silence, the same as a new band count
+    const bool wantsLinearPhase = chainSettings.crossoverMode == 1;
+
+    if (wantsLinearPhase != linearPhase)
+    {
+        // neither engine may keep the tail it held when it was last active, and the high cut carried the other engine's output
+        linearPhase = wantsLinearPhase;
+        crossover.reset();
+        linearCrossover.reset();
+
+        for (auto& chain : engine.channelChains)
+            chain.highCut.reset();
+
+        resetBands<SampleType>();
+    }
+    else if (chainSettings.numBands != crossover.getNumBands() || chainSettings.midSide != midSide)
+    {
+        resetBands<SampleType>();
+    }
+
+    midSide = chainSettings.midSide;
+
+    crossover.setSplits(chainSettings.numBands, frequencies);
+    linearCrossover.setSplits(chainSettings.numBands, frequencies);
+
+    for (int pair = 0; pair < stereoKernels.size(); ++pair)
+    {
+        stereoKernels[pair]->setCrossoverFrequency(crossoverFreq);
+        stereoKernels[pair]->setMidSide(midSide && pair == 0);
+    }
+}
+
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::updateDistortion(const ChainSettings& chainSettings)
+{
+    auto& channelChains = getEngine<SampleType>().channelChains;
+    auto& stereoKernels = getEngine<SampleType>().stereoKernels;
+
+    for (int channel = 0; channel < (int) channelChains.size(); ++channel)
+    {
+        auto& chain = channelChains[(size_t) channel];
+        const auto knobs = getChannelIntensities(chainSettings, chainSettings.midSide && channel == 1);
+
+        for (int band = 0; band < chainSettings.numBands; ++band)
+            chain.distortion[band] = getDistortionSettings(getBandIntensity(knobs.distLow, knobs.distHigh, band, chainSettings.numBands));
+    }
+
+    for (int pair = 0; pair < stereoKernels.size(); ++pair)
+    {
+        const auto a = getChannelIntensities(chainSettings, false);
+        const auto b = getChannelIntensities(chainSettings, chainSettings.midSide && pair == 0);
+
+        const distortionSettings distortionLanes[] = { getDistortionSettings(a.distLow), getDistortionSettings(a.distHigh),
+                                                       getDistortionSettings(b.distLow), getDistortionSettings(b.distHigh) };
+
+        stereoKernels[pair]->setDistortion(chainSettings.distortionType, distortionLanes);
+        stereoKernels[pair]->setAntiAliasing(chainSettings.distortionADAA);
+    }
+}
+
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::updateOversampling(const ChainSettings& chainSettings)
+{
+    auto& engine = getEngine<SampleType>();
+
+    for (auto* kernel : engine.stereoKernels)
+        kernel->setOversampling(chainSettings.oversamplingFactor, chainSettings.oversamplingFilter);
+
+    for (auto& chain : engine.channelChains)
+        chain.oversampler.select(chainSettings.oversamplingFactor, chainSettings.oversamplingFilter);
+}
+
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::updateLimiter(const ChainSettings& chainSettings)
+{
+    auto& truePeakLimiter = getEngine<SampleType>().truePeakLimiter;
+
+    truePeakLimiter.setCeiling(chainSettings.ceilingDB);
+
+    // switched back on: start from an empty delay line, not from what it held when it was switched off
+    if (chainSettings.truePeakCeiling && ! ceilingActive)
+        truePeakLimiter.reset();
+
+    ceilingActive = chainSettings.truePeakCeiling;
+}
+
+
+int SimpleEQAudioProcessor::getLookaheadSamples(const ChainSettings& chainSettings) const
+{
+    return juce::roundToInt(chainSettings.lookaheadMs * 0.001 * getSampleRate());
+}
+
+
+// ADAA's difference quotient delays by half a sample per stage (WARM 1, CRUSH 2, DON'T 3) at the rate it runs at,
+// rounded to the nearest sample at the base rate. What's left over is at most half a sample between dry and wet:
+// at worst a 50 / 50 mix is 3 dB down at Nyquist, about 0.6 dB at 10 kHz at 44.1 kHz, nothing below
+int SimpleEQAudioProcessor::getAntiAliasingLatency(const ChainSettings& chainSettings) const
+{
+    if (! chainSettings.distortionADAA)
+        return 0;
+
+    // what DistortionOversampler::select makes of the index, the same in either engine
+    const int halfSamples = chainSettings.distortionType + 1;
+    const int factor = 1 << juce::jlimit(0, DistortionOversampler<float>::numFactors - 1, chainSettings.oversamplingFactor);
+
+    return (halfSamples + factor) / (2 * factor);
+}
+
+
+// everything on the signal path that delays it, in the order it runs
+template <typename SampleType>
+void SimpleEQAudioProcessor::updateLatency(const ChainSettings& chainSettings)
+{
+    auto& engine = getEngine<SampleType>();
+    auto& channelChains = engine.channelChains;
+
+    const int crossoverLatency = linearPhase ? LinearPhaseCrossover::latencySamples : 0;
+
+    // kernels and chains use the same oversampling filters, so the same latency
+    const int oversamplingLatency = channelChains.empty() ? 0 : channelChains.front().oversampler.getLatencySamples();
+
+    // the dry path has to wait for all of the chain, the ceiling comes after the mix and delays both
+    const int chainLatency = crossoverLatency + oversamplingLatency + getAntiAliasingLatency(chainSettings)
+                           + getLookaheadSamples(chainSettings);
+    engine.dryWet.setLatency(chainLatency);
+
+    // the linear phase crossover splits the key too, only what the signal meets after the split is missing from it
+    engine.keyDelay.setDelay(oversamplingLatency + getAntiAliasingLatency(chainSettings));
+
+    const int ceilingLatency = ceilingActive ? engine.truePeakLimiter.getLatencySamples() : 0;
+
+    reportedLatency.store(chainLatency + ceilingLatency);
+
+    // after the last input sample: everything is still in the delays, then the linear phase kernels' second half
+    // and whatever the IIR filters ring for
+    const int kernelTail = linearPhase ? LinearPhaseCrossover::kernelLength - LinearPhaseCrossover::kernelDelay : 0;
+    tailSamples = chainLatency + ceilingLatency + kernelTail + juce::roundToInt(ringingSeconds * getSampleRate());
+    tailSeconds.store(tailSamples / getSampleRate(), std::memory_order_relaxed);
+}
+
+
+void SimpleEQAudioProcessor::timerCallback()
+{
+    const int latency = reportedLatency.load();
+
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
+
+void SimpleEQAudioProcessor::parameterChanged(const juce::String& parameterID, float)
+{
+    if (parameterID == "oversampling" || parameterID == "oversamplingFilter")
+        dirtyFlags.fetch_or(oversamplingDirty | latencyDirty);
+    else if (parameterID == "crossoverMode")
+        dirtyFlags.fetch_or(crossoverDirty | latencyDirty);
+    else if (parameterID == "lookahead")
+        dirtyFlags.fetch_or(compressorDirty | latencyDirty);
+    else if (parameterID == "truePeakCeiling" || parameterID == "ceiling")
+        dirtyFlags.fetch_or(limiterDirty | latencyDirty);
+    else if (parameterID == "mix" || parameterID == "externalSidechain")
+        return; // nothing derived, processBlock reads them straight from the snapshot
+    else if (parameterID == "stereoMode")
+        dirtyFlags.fetch_or(crossoverDirty | compressorDirty | distortionDirty); // channel 1 switches to the side knobs
+    else if (parameterID == "numBands")
+        dirtyFlags.fetch_or(crossoverDirty | compressorDirty | distortionDirty); // the per band intensities move too
+    else if (parameterID.startsWith("bandsplit_frequency"))
+        dirtyFlags.fetch_or(crossoverDirty);
+    else if (parameterID == "highCutFreq")
+        dirtyFlags.fetch_or(filterDirty);
+    else if (parameterID == "distortionType" || parameterID == "distortionADAA")
+        dirtyFlags.fetch_or(distortionDirty | latencyDirty); // ADAA's delay depends on both
+    else if (parameterID.startsWith("dist")) // intensities (main and side)
+        dirtyFlags.fetch_or(distortionDirty);
+    else
+        dirtyFlags.fetch_or(compressorDirty); // compLow/HighIntensity(Side), compressorSpeed, compressorControlRate
+}
+
+
 
 
 
@@ -430,6 +1389,48 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
                                                                  "bandsplit_frequency",
                                                                  juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
                                                                  660.f));
+    
+    // MORE BANDS (mastering) ----
+    layout.add(std::make_unique<juce::AudioParameterInt>(juce::ParameterID("numBands", 1),
+                                                         "Bands",
+                                                         2, CrossoverTree<float>::maxBands, 2));
+    
+    const float extraSplitDefaults[] = { 2500.f, 6000.f, 12000.f };
+    
+    for (int split = 0; split < 3; ++split)
+    {
+        const juce::String id = "bandsplit_frequency_" + juce::String(split + 2);
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID(id, 1),
+                                                               id,
+                                                               juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                               extraSplitDefaults[split]));
+    }
+    
+    // linear phase costs partitionSize + half the FIR in latency
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("crossoverMode", 1),
+                                                            "Crossover Mode",
+                                                            juce::StringArray { "Minimum Phase", "Linear Phase" },
+                                                            0));
+    
+    // MID/SIDE ----
+    // the normal intensity knobs drive the mid, these the side
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("stereoMode", 1),
+                                                            "Stereo Mode",
+                                                            juce::StringArray { "Left/Right", "Mid/Side" },
+                                                            0));
+    
+    for (auto* id : { "compLowIntensitySide", "compHighIntensitySide" })
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID(id, 1),
+                                                               id,
+                                                               juce::NormalisableRange<float>(0.f, 1.f, 0.05f, 0.55f),
+                                                               0.f));
+    
+    for (auto* id : { "distLowIntensitySide", "distHighIntensitySide" })
+        layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID(id, 1),
+                                                               id,
+                                                               juce::NormalisableRange<float>(0.f, 1.f, 0.05f, 0.75f),
+                                                               0.f));
+    
     // COMP ----
     layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("compLowIntensity", 1),
                                                                  "compLowIntensity",
@@ -468,6 +1469,62 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
                                                                  "highCutFreq",
                                                                  juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
                                                                 20000.f));
+    
+    // OVERSAMPLING (distortion stage only) ----
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("oversampling", 1),
+                                                            "Oversampling",
+                                                            juce::StringArray { "1x", "2x", "4x", "8x" },
+                                                            0));
+    
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("oversamplingFilter", 1),
+                                                            "Oversampling Filter",
+                                                            juce::StringArray { "Low Latency", "Linear Phase" },
+                                                            0));
+    
+    // cheaper alternative to oversampling, can also be stacked on top of it
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID("distortionADAA", 1),
+                                                          "Anti-Aliasing (ADAA)",
+                                                          false));
+    
+    // samples between compressor gain updates. Both compressors used to update every sample, so that's the default:
+    // sessions saved before this parameter existed keep GLUE's one sample attack and sound the same
+    layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID("compressorControlRate", 1),
+                                                            "Compressor Control Rate",
+                                                            juce::StringArray { "1", "8", "16", "32" },
+                                                            0));
+    
+    // pulls the detectors of a channel pair together, at 100% both channels get the same gain reduction
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("stereoLink", 1),
+                                                           "Stereo Link",
+                                                           juce::NormalisableRange<float>(0.f, 1.f, 0.01f),
+                                                           0.f));
+    
+    // the downward compressors see this far ahead, adds the same to the latency
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("lookahead", 1),
+                                                           "Lookahead (ms)",
+                                                           juce::NormalisableRange<float>(0.f, DownwardCompressor<float>::maxLookaheadMs, 0.1f),
+                                                           0.f));
+    
+    // keys the downward compressors from the sidechain bus (when the host connects one)
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID("externalSidechain", 1),
+                                                          "External Sidechain",
+                                                          false));
+    
+    // MIX ----
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("mix", 1),
+                                                           "Mix",
+                                                           juce::NormalisableRange<float>(0.f, 1.f, 0.01f),
+                                                           1.f));
+    
+    // OUTPUT CEILING ----
+    layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID("truePeakCeiling", 1),
+                                                          "True Peak Ceiling",
+                                                          false));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("ceiling", 1),
+                                                           "Ceiling (dBTP)",
+                                                           juce::NormalisableRange<float>(-12.f, 0.f, 0.1f),
+                                                           -1.f));
         
 
     return layout;
@@ -475,25 +1532,72 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
 
 
 
-float SimpleEQAudioProcessor::distortionSample(float x, float y_old, float drive, float c)
+int getDistortionType(float distRaw)
+{
+    if      (distRaw < 0.4f) return 0; // WARM
+    else if (distRaw < 0.6f) return 1; // CRUSH
+    else                     return 2; // DON'T!
+}
+
+
+template <int DistType, typename SampleType>
+SampleType SimpleEQAudioProcessor::distortionSample(SampleType x, DistortionState<SampleType>& state, float drive, float c, float alpha)
 {
-    float distRaw = apvts.getRawParameterValue("distortionType")->load();
-    int distType;
+    if constexpr (DistType == 0)
+        return distortionWarm(x, drive, c);
+    else if constexpr (DistType == 1)
+        return distortionCrush(x, state, drive, c, alpha);
+    else
+        return distortionDONT(x, state, drive, c, alpha);
+}
+
 
-    if      (distRaw < 0.4f) distType = 0; // WARM
-    else if (distRaw < 0.6f) distType = 1; // CRUSH
-    else                    distType = 2; // DON'T!
+// the type is resolved once per chunk, the loops below only ever see one curve
+template <int DistType, typename SampleType>
+void SimpleEQAudioProcessor::distortBands(juce::dsp::AudioBlock<SampleType>& bands, DistortionState<SampleType>* bandStates,
+                                          const distortionSettings* bandSettings, bool adaa, float envelopeAlpha)
+{
+    const int numSamples = (int) bands.getNumSamples();
 
-    switch (distType)
+    for (size_t band = 0; band < bands.getNumChannels(); ++band)
     {
-        case 0:
-            return distortionWarm(x, y_old, drive, c);
-        case 1:
-            return distortionCrush(x, y_old, drive, c);
-        case 2:
-            return distortionDONT(x, y_old, drive, c);
-        default:
-            return x;
+        SampleType* data = bands.getChannelPointer(band);
+        DistortionState<SampleType>& state = bandStates[band];
+        const distortionSettings& settings = bandSettings[band];
+
+        // x1 only follows the signal while ADAA runs, the first sample back primes it
+        if (! adaa)
+            state.adaaPrimed = false;
+
+        // an untouched WARM band that quiet is passed as it is, the switch moves the output by less than -60 dB
+        // so it needs no fade (ADAA isn't an identity at any level, it's a half sample average)
+        if constexpr (DistType == 0)
+        {
+            if (! adaa && settings.drive == 1.0f
+                && juce::jmax(juce::FloatVectorOperations::findMaximum(data, numSamples),
+                              -juce::FloatVectorOperations::findMinimum(data, numSamples)) <= (SampleType) warmIdentityPeak)
+                continue;
+        }
+
+        if (adaa)
+        {
+            int i = 0;
+
+            if (! state.adaaPrimed && numSamples > 0)
+            {
+                data[0] = distortionSampleADAA<DistType>(data[0], state, settings.drive, envelopeAlpha, true);
+                state.adaaPrimed = true;
+                i = 1;
+            }
+
+            for (; i < numSamples; ++i)
+                data[i] = distortionSampleADAA<DistType>(data[i], state, settings.drive, envelopeAlpha);
+        }
+        else
+        {
+            for (int i = 0; i < numSamples; ++i)
+                data[i] = distortionSample<DistType>(data[i], state, settings.drive, settings.c, envelopeAlpha);
+        }
     }
 }
 
@@ -507,62 +1611,152 @@ float SimpleEQAudioProcessor::asymmetricSoftClip(float x, float posThreshold, fl
 
 
 
-float SimpleEQAudioProcessor::distortionWarm(float x, float y_old, float drive, float c)
+// the curves are float tables (and fastTanh) in either precision, a double sample only goes through them as a float
+template <typename SampleType>
+SampleType SimpleEQAudioProcessor::distortionWarm(SampleType x, float drive, float c)
 {
- 
-
-    float softClip = std::tanh(drive * x);
-
-    softClip += 0.15f * softClip * softClip * softClip;
-    
-    float scale = 1.0f / (1.0f + (0.295f) * (drive - 1.0f));
-    
-    return scale * softClip;
+    // tanh(drive * x) + 0.15 * tanh^3, scaled back down for the drive
+    return (SampleType) waveshaperTables->warm((float) x, drive);
 }
 
 
-float SimpleEQAudioProcessor::distortionCrush(float x, float y_old, float drive, float c)
+template <typename SampleType>
+SampleType SimpleEQAudioProcessor::distortionCrush(SampleType x, DistortionState<SampleType>& state, float drive, float c, float alpha)
 {
-    // signal envelope (RMS-based)
-    static float envelope = 0.0f;
-    float alpha = 0.001f; // Smoothing factor
-    envelope = (1.0f - alpha) * envelope + alpha * std::fabs(x);
+    // signal envelope (RMS-based), alpha already scaled for the oversampling factor
+    state.envelope = (SampleType) (1.0f - alpha) * state.envelope + (SampleType) alpha * std::abs(x);
 
     // volume-dependent gain scaling (higher volume = more saturation)
-    float dynamicDrive = drive * (1.0f + 0.5f * envelope);
+    float dynamicDrive = drive * (1.0f + 0.5f * (float) state.envelope);
     
     float scale = 1.0f / (1.0f + (0.3f) * (drive - 1.0f));
  
-    float warm = distortionWarm( x, y_old,  dynamicDrive,  c);
-    
-    float saturated =scale *std::tanh(dynamicDrive * warm);
+    // tanh(dynamicDrive * distortionWarm(x, dynamicDrive)) in one lookup
+    float saturated = scale * waveshaperTables->crushCore((float) x, dynamicDrive);
     
 
-    return saturated;
+    return (SampleType) saturated;
 }
 
-float SimpleEQAudioProcessor::distortionDONT(float x, float y_old, float drive, float c)
+template <typename SampleType>
+SampleType SimpleEQAudioProcessor::distortionDONT(SampleType x, DistortionState<SampleType>& state, float drive, float c, float alpha)
 {
-    static float envelope = 0.0f;
-    float alpha = 0.001f;
-    envelope = (1.0f - alpha) * envelope + alpha * std::fabs(x);
+    state.envelope = (SampleType) (1.0f - alpha) * state.envelope + (SampleType) alpha * std::abs(x);
 
-    float dynamicDrive = drive * drive * (1.0f + 0.5f * envelope);
+    float dynamicDrive = drive * drive * (1.0f + 0.5f * (float) state.envelope);
     float scale = 1.0f / (1.0f + 0.3f * (drive - 1.0f));
 
-    float warm = distortionWarm(x, y_old, dynamicDrive, c);
-    float saturated = scale * std::tanh(dynamicDrive * warm);
-    float saturated2 = std::tanh(dynamicDrive * dynamicDrive * saturated);
+    float saturated = scale * waveshaperTables->crushCore((float) x, dynamicDrive);
+    float saturated2 = fastTanh::tanh(dynamicDrive * dynamicDrive * saturated);
 
     // turn down volume with higher drives!
     float gainCompensation = juce::jmap(drive, 1.0f, 7.0f, 0.5f, 0.1f);  // from 0.5 to 0.1
 
     gainCompensation = std::pow(gainCompensation, 1.3f); // COMPENSATION CURVE --> NONLINEAR (TO TWEAK)
 
-    return saturated2 * gainCompensation;
+    return (SampleType) (saturated2 * gainCompensation);
+}
+
+
+
+
+
+
+// ADAA -----------------------------
+//
+// y[n] = (F(x[n]) - F(x[n-1])) / (x[n] - x[n-1]) with F the antiderivative of the curve.
+// Every stage adds half a sample of delay, both bands go through the same cascade so the crossover sum still lines up.
+
+// below this input step the difference quotient is ill-conditioned, use f at the midpoint instead
+static constexpr double adaaTolerance = 1.0e-5;
+
+// log(cosh(u)) without overflowing for large |u|
+static inline double logCosh(double u)
+{
+    u = std::abs(u);
+    return u + std::log1p(std::exp(-2.0 * u)) - 0.69314718055994530942; // ln 2
+}
+
+// the antiderivatives run in double whatever the sample type, the midpoint fallback in float (fastTanh)
+
+// tanh(k x),  F = logcosh(k x) / k
+template <typename SampleType>
+static inline SampleType tanhADAA(SampleType x, SampleType& x1, float k)
+{
+    const double dx = (double) x - (double) x1;
+    const SampleType y = std::abs(dx) < adaaTolerance
+                       ? (SampleType) fastTanh::tanh(k * 0.5f * (float) (x + x1))
+                       : (SampleType) ((logCosh((double) k * x) - logCosh((double) k * x1)) / (k * dx));
+    x1 = x;
+    return y;
+}
+
+// WARM: s (t + 0.15 t^3), t = tanh(d x),  F = s / d (1.15 logcosh(d x) - 0.075 t^2)
+template <typename SampleType>
+static inline SampleType warmADAA(SampleType x, SampleType& x1, float d)
+{
+    const float scale = 1.0f / (1.0f + 0.295f * (d - 1.0f));
+    const double dx = (double) x - (double) x1;
+    SampleType y;
+
+    if (std::abs(dx) < adaaTolerance)
+    {
+        const float t = fastTanh::tanh(d * 0.5f * (float) (x + x1));
+        y = (SampleType) (t + 0.15f * t * t * t);
+    }
+    else
+    {
+        auto antiderivative = [d](double v)
+        {
+            const double t = std::tanh(d * v);
+            return 1.15 * logCosh(d * v) - 0.075 * t * t;
+        };
+
+        y = (SampleType) ((antiderivative(x) - antiderivative(x1)) / (d * dx));
+    }
+
+    x1 = x;
+    return (SampleType) scale * y;
+}
+
+// the three distortion types as ADAA cascades, dynamicDrive already includes the envelope
+// prime: x1 is stale (ADAA was just switched on), every stage starts from its own input so this sample is the plain
+// curve (the midpoint fallback) instead of an average reaching back to whatever x1 held
+template <typename SampleType>
+static inline SampleType curveADAA(SampleType x, SampleType* x1, int distType, float dynamicDrive, float crushScale, float dontGain,
+                                   bool prime = false)
+{
+    if (prime) x1[0] = x;
+    SampleType y = warmADAA(x, x1[0], dynamicDrive);
+    if (distType == 0)
+        return y;
+
+    if (prime) x1[1] = y;
+    y = (SampleType) crushScale * tanhADAA(y, x1[1], dynamicDrive);
+    if (distType == 1)
+        return y;
+
+    if (prime) x1[2] = y;
+    return (SampleType) dontGain * tanhADAA(y, x1[2], dynamicDrive * dynamicDrive);
 }
 
 
+template <int DistType, typename SampleType>
+SampleType SimpleEQAudioProcessor::distortionSampleADAA(SampleType x, DistortionState<SampleType>& state, float drive, float alpha, bool prime)
+{
+    if constexpr (DistType == 0)
+        return curveADAA(x, state.x1, 0, drive, 1.0f, 1.0f, prime);
+
+    // same envelope and gain staging as distortionCrush / distortionDONT
+    state.envelope = (SampleType) (1.0f - alpha) * state.envelope + (SampleType) alpha * std::abs(x);
+
+    const float envelopeDrive = 1.0f + 0.5f * (float) state.envelope;
+    const float dynamicDrive = (DistType == 1 ? drive : drive * drive) * envelopeDrive;
+    const float scale = 1.0f / (1.0f + 0.3f * (drive - 1.0f));
+    const float gainCompensation = std::pow(juce::jmap(drive, 1.0f, 7.0f, 0.5f, 0.1f), 1.3f);
+
+    return curveADAA(x, state.x1, DistType, dynamicDrive, scale, gainCompensation, prime);
+}
 
 
 
@@ -580,113 +1774,441 @@ distortionSettings SimpleEQAudioProcessor::getDistortionSettings(const double in
 // upward compression -----------------------------
 
 
-inline float upwardCompressSample(float input, float thresholdDB, float ratio)
+float getBallisticsCoefficient(double sampleRate, float timeMs)
+{
+    return timeMs < 1.0e-3f ? 0.0f
+                            : (float) std::exp(-2.0 * juce::MathConstants<double>::pi * 1000.0 / sampleRate / timeMs);
+}
+
+
+void UpwardGainComputer::set(const UpwardCompressorSettings& settings)
 {
-    float linearThresh = juce::Decibels::decibelsToGain(thresholdDB);
-    float inputAbs = std::abs(input);
+    thresholdDB = settings.threshold;
+    slope = 1.0f - 1.0f / settings.ratio;
 
-    if (inputAbs < linearThresh)
-    {
-        // How far below the threshold? --> calc the gain based on this val
-        float diff = (linearThresh - inputAbs) / linearThresh;
+    // the most the old per-sample curve could lift (1 + (ratio - 1) at silence, on top of its doubling)
+    maxBoostDB = juce::Decibels::gainToDecibels(0.5f * (settings.ratio + 1.0f));
+}
 
-        // Nonlinear gain
-        float gain = 1.0f + std::pow(diff, 4.f) * (ratio - 1.0f);  //exponent == softness
 
-        return input * gain;
-    }
-    else
-    {
-        return input;
-    }
+template <typename SampleType>
+SampleType UpwardGainComputer::getGain(SampleType envelope) const noexcept
+{
+    const SampleType levelDB = juce::Decibels::gainToDecibels(envelope, (SampleType) -200);
+    const SampleType boostDB = juce::jlimit((SampleType) 0, (SampleType) maxBoostDB, ((SampleType) thresholdDB - levelDB) * (SampleType) slope);
+
+    // OTT has always added the compressed band on top of the dry one, keep that +6 dB
+    return (SampleType) 2 * juce::Decibels::decibelsToGain(boostDB);
 }
 
+template float UpwardGainComputer::getGain(float) const noexcept;
+template double UpwardGainComputer::getGain(double) const noexcept;
 
 
-std::pair<float, float> SimpleEQAudioProcessor::applyUpwardCompression(float low, float high)
+template <typename SampleType>
+void UpwardCompressor<SampleType>::prepare(double sampleRate)
 {
-    
-    ChainSettings chainsettings = getChainSettings(apvts);
-    float intensityLow = chainsettings.compLowIntensity;
-    float intensityHigh = chainsettings.compHighIntensity;
-    auto settingsLow  = getUpwardCompSettings(intensityLow);
-    auto settingsHigh = getUpwardCompSettings(intensityHigh);
+    attackCte  = (SampleType) getBallisticsCoefficient(sampleRate, attackMs);
+    releaseCte = (SampleType) getBallisticsCoefficient(sampleRate, releaseMs);
+    reset();
+}
 
-    low  += upwardCompressSample(low,  settingsLow.threshold,  settingsLow.ratio);
-    high += upwardCompressSample(high, settingsHigh.threshold, settingsHigh.ratio);
 
-    return { low, high };
+template <typename SampleType>
+void UpwardCompressor<SampleType>::reset()
+{
+    envelope = 0.0f;
+    gain = 2.0f; // no lift yet, just the fixed +6 dB
+    gainStep = 0.0f;
+    samplesUntilUpdate = 0;
 }
 
 
-UpwardCompressorSettings SimpleEQAudioProcessor::getUpwardCompSettings(const double intensity)
+template <typename SampleType>
+void DownwardCompressor<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
 {
-    UpwardCompressorSettings settings;
+    sampleRate = spec.sampleRate;
+    channels.resize(spec.numChannels);
 
-    // Lower threshold catches quieter signals
-    settings.threshold = juce::jmap(float(intensity), 0.0f, 1.0f, -60.0f, -30.0f);
+    // room for the longest lookahead, so changing it never allocates
+    const int maxLookahead = (int) std::ceil(maxLookaheadMs * 0.001 * sampleRate);
+    delayMask = juce::nextPowerOfTwo(maxLookahead + 1) - 1;
+    lookahead = juce::jmin(lookahead, delayMask);
 
-    // Higher intensity = more upward lift (stronger ratio)
-    settings.ratio = juce::jmap(float(intensity), 0.0f, 1.0f, 1.5f, 3.5f);
+    for (auto& state : channels)
+        state.delayLine.assign((size_t) delayMask + 1, (SampleType) 0);
 
-    return settings;
+    fadeSamples = juce::jmax(1, juce::roundToInt(fadeMs * 0.001 * sampleRate));
+
+    updateCoefficients();
+    reset();
 }
 
-//==============================================================================
-// This creates new instances of the plugin..
-juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
+
+template <typename SampleType>
+void DownwardCompressor<SampleType>::reset()
 {
-    return new SimpleEQAudioProcessor();
+    for (auto& state : channels)
+    {
+        state.envelope = 0.0f;
+        state.gain = 1.0f;
+        state.gainStep = 0.0f;
+        state.samplesUntilUpdate = 0;
+
+        std::fill(state.delayLine.begin(), state.delayLine.end(), (SampleType) 0);
+        state.writeIndex = 0;
+    }
+
+    amount = amountTarget;
+    fadeRemaining = 0;
 }
 
 
+template <typename SampleType>
+void DownwardCompressor<SampleType>::setThreshold(float newThresholdDB) { thresholdDB = newThresholdDB; updateCoefficients(); }
+template <typename SampleType>
+void DownwardCompressor<SampleType>::setRatio(float newRatio)           { jassert(newRatio >= 1.0f); ratio = newRatio; updateCoefficients(); updateAmount(); }
+template <typename SampleType>
+void DownwardCompressor<SampleType>::setAttack(float newAttackMs)       { attackMs = newAttackMs; updateCoefficients(); }
+template <typename SampleType>
+void DownwardCompressor<SampleType>::setRelease(float newReleaseMs)     { releaseMs = newReleaseMs; updateCoefficients(); }
 
-// ==================== AUDIO BUFFER FIFO FOR VISUALIZER =========================
 
-//void AudioBufferQueue::push(const juce::AudioBuffer<float>& buffer)
-//    {
-//        const auto start1 = fifo.write(1);
-//        if (start1.blockSize1 > 0)
-//            buffers[(int)start1.startIndex1].makeCopyOf(buffer);
-//    }
-//
-//const juce::AudioBuffer<float>& AudioBufferQueue::getLatest()
-//    {
-//        const auto start1 = fifo.read(1);
-//        if (start1.blockSize1 > 0)
-//            return buffers[(int)start1.startIndex1];
-//        return dummy;
-//    }
-//
+template <typename SampleType>
+void DownwardCompressor<SampleType>::updateCoefficients()
+{
+    thresholdInverse = (SampleType) 1 / juce::Decibels::decibelsToGain((SampleType) thresholdDB, (SampleType) -200);
+    ratioInverse = (SampleType) 1 / (SampleType) ratio;
 
+    attackCte  = (SampleType) getBallisticsCoefficient(sampleRate, attackMs);
+    releaseCte = (SampleType) getBallisticsCoefficient(sampleRate, releaseMs);
+}
+
+
+template <typename SampleType>
+void DownwardCompressor<SampleType>::updateAmount()
+{
+    const float target = ratio < identityRatio ? 0.0f : 1.0f;
 
-void FFTDataGenerator::pushSamples(const juce::AudioBuffer<float>& buffer)
+    if (target == amountTarget)
+        return;
+
+    // back from all the way off: the detector hasn't seen anything in the meantime
+    if (target > 0.0f && amount == 0.0f)
     {
-        auto* channelData = buffer.getReadPointer(0);
-        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        for (auto& state : channels)
         {
-            if (fifoIndex == fftSize)
-            {
-                if (!nextFFTBlockReady)
-                {
-                    memcpy(fftData, fifo, sizeof(fifo));
-                    nextFFTBlockReady = true;
-                }
-                fifoIndex = 0;
-            }
-
-            fifo[fifoIndex++] = channelData[i];
+            state.envelope = 0.0f;
+            state.gain = 1.0f;
+            state.gainStep = 0.0f;
+            state.samplesUntilUpdate = 0;
         }
     }
 
-    // Do FFT and return magnitude bins in dB
-//bool FFTDataGenerator::produceFFTData(std::vector<float>& outputBins)
-//    {
-//        if (!nextFFTBlockReady) return false;
-//
-//        window.multiplyWithWindowingTable(fifo, fftSize); // Apply window
-//        memcpy(fftData, fifo, sizeof(fifo));
-//        forwardFFT.performFrequencyOnlyForwardTransform(fftData);
+    amountTarget = target;
+    amountStep = (target - amount) / (float) fadeSamples;
+    fadeRemaining = fadeSamples;
+}
+
+
+template <typename SampleType>
+SampleType DownwardCompressor<SampleType>::blend(SampleType gain) noexcept
+{
+    if (fadeRemaining > 0)
+        amount = --fadeRemaining == 0 ? amountTarget : amount + amountStep;
+
+    return (SampleType) 1 + (SampleType) amount * (gain - (SampleType) 1);
+}
+
+
+template <typename SampleType>
+SampleType DownwardCompressor<SampleType>::computeGain(SampleType envelope) const noexcept
+{
+    // same static curve as juce::dsp::Compressor
+    return envelope * thresholdInverse < (SampleType) 1 ? (SampleType) 1
+                                                        : std::pow(envelope * thresholdInverse, ratioInverse - (SampleType) 1);
+}
+
+
+template <typename SampleType>
+SampleType DownwardCompressor<SampleType>::nextGain(ChannelState& state, SampleType level) noexcept
+{
+    // peak detector, every sample
+    const SampleType cte = level > state.envelope ? attackCte : releaseCte;
+    state.envelope = level + cte * (state.envelope - level);
+
+    // gain, every controlInterval samples
+    if (--state.samplesUntilUpdate <= 0)
+    {
+        state.samplesUntilUpdate = controlInterval;
+        state.gainStep = (computeGain(state.envelope) - state.gain) / (SampleType) controlInterval;
+    }
+
+    state.gain += state.gainStep;
+    return state.gain;
+}
+
+
+template <typename SampleType>
+SampleType DownwardCompressor<SampleType>::delay(ChannelState& state, SampleType x) const noexcept
+{
+    state.delayLine[(size_t) state.writeIndex] = x;
+    const SampleType delayed = state.delayLine[(size_t) ((state.writeIndex - lookahead) & delayMask)];
+    state.writeIndex = (state.writeIndex + 1) & delayMask;
+
+    return delayed;
+}
+
+
+template <typename SampleType>
+void DownwardCompressor<SampleType>::processKeyed(SampleType* samples, const SampleType* key, int numSamples) noexcept
+{
+    auto& state = channels[0];
+
+    if (isSkipped())
+    {
+        if (lookahead > 0)
+            for (int i = 0; i < numSamples; ++i)
+                samples[i] = delay(state, samples[i]);
+
+        return;
+    }
+
+    const bool fading = isFading();
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        SampleType gain = nextGain(state, std::abs(key[i]));
+
+        if (fading)
+            gain = blend(gain);
+
+        samples[i] = delay(state, samples[i]) * gain;
+    }
+}
+
+
+template <typename SampleType>
+void DownwardCompressor<SampleType>::processLinked(DownwardCompressor& partner, SampleType* left, SampleType* right, const SampleType* keyLeft, const SampleType* keyRight,
+                                       int numSamples, float link) noexcept
+{
+    auto& stateL = channels[0];
+    auto& stateR = partner.channels[0];
+
+    // same settings on both, so both are identities or neither is
+    if (isSkipped() && partner.isSkipped())
+    {
+        if (lookahead > 0)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                left[i]  = delay(stateL, left[i]);
+                right[i] = partner.delay(stateR, right[i]);
+            }
+        }
+
+        return;
+    }
+
+    const bool fading = isFading() || partner.isFading();
+
+    // fully linked: one detector on the louder channel, its gain goes to both
+    if (link >= 1.0f)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const SampleType gain = nextGain(stateL, juce::jmax(std::abs(keyLeft[i]), std::abs(keyRight[i])));
+            left[i]  = delay(stateL, left[i]) * (fading ? blend(gain) : gain);
+            right[i] = partner.delay(stateR, right[i]) * (fading ? partner.blend(gain) : gain);
+        }
+
+        // so the right detector carries on from here when the link is lowered again
+        stateR.envelope = stateL.envelope;
+        stateR.gain = stateL.gain;
+        stateR.gainStep = stateL.gainStep;
+        stateR.samplesUntilUpdate = stateL.samplesUntilUpdate;
+        return;
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const SampleType levelL = std::abs(keyLeft[i]);
+        const SampleType levelR = std::abs(keyRight[i]);
+        const SampleType louder = juce::jmax(levelL, levelR);
+
+        const SampleType gainL = nextGain(stateL, levelL + (SampleType) link * (louder - levelL));
+        const SampleType gainR = partner.nextGain(stateR, levelR + (SampleType) link * (louder - levelR));
+
+        left[i]  = delay(stateL, left[i]) * (fading ? blend(gainL) : gainL);
+        right[i] = partner.delay(stateR, right[i]) * (fading ? partner.blend(gainR) : gainR);
+    }
+}
+
+
+template <typename SampleType>
+SampleType UpwardCompressor<SampleType>::nextGain(SampleType level) noexcept
+{
+    const SampleType cte = level > envelope ? attackCte : releaseCte;
+    envelope = level + cte * (envelope - level);
+
+    // control rate: new target from the envelope, reached linearly over the next interval
+    if (--samplesUntilUpdate <= 0)
+    {
+        samplesUntilUpdate = controlInterval;
+        gainStep = (computer.getGain(envelope) - gain) / (SampleType) controlInterval;
+    }
+
+    gain += gainStep;
+    return gain;
+}
+
+
+template <typename SampleType>
+void UpwardCompressor<SampleType>::process(SampleType* samples, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+        samples[i] *= nextGain(std::abs(samples[i]));
+}
+
+
+template <typename SampleType>
+void UpwardCompressor<SampleType>::processLinked(UpwardCompressor& partner, SampleType* left, SampleType* right, int numSamples, float link) noexcept
+{
+    if (link >= 1.0f)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const SampleType lift = nextGain(juce::jmax(std::abs(left[i]), std::abs(right[i])));
+            left[i]  *= lift;
+            right[i] *= lift;
+        }
+
+        partner.envelope = envelope;
+        partner.gain = gain;
+        partner.gainStep = gainStep;
+        partner.samplesUntilUpdate = samplesUntilUpdate;
+        return;
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const SampleType levelL = std::abs(left[i]);
+        const SampleType levelR = std::abs(right[i]);
+        const SampleType louder = juce::jmax(levelL, levelR);
+
+        left[i]  *= nextGain(levelL + (SampleType) link * (louder - levelL));
+        right[i] *= partner.nextGain(levelR + (SampleType) link * (louder - levelR));
+    }
+}
+
+
+template class DownwardCompressor<float>;
+template class DownwardCompressor<double>;
+template class UpwardCompressor<float>;
+template class UpwardCompressor<double>;
+
+
+UpwardCompressorSettings SimpleEQAudioProcessor::getUpwardCompSettings(const double intensity)
+{
+    UpwardCompressorSettings settings;
+
+    // Lower threshold catches quieter signals
+    settings.threshold = juce::jmap(float(intensity), 0.0f, 1.0f, -60.0f, -30.0f);
+
+    // Higher intensity = more upward lift (stronger ratio)
+    settings.ratio = juce::jmap(float(intensity), 0.0f, 1.0f, 1.5f, 3.5f);
+
+    return settings;
+}
+
+//==============================================================================
+// This creates new instances of the plugin..
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
+{
+    return new SimpleEQAudioProcessor();
+}
+
+
+
+// ==================== AUDIO BUFFER FIFO FOR VISUALIZER =========================
+
+//void AudioBufferQueue::push(const juce::AudioBuffer<float>& buffer)
+//    {
+//        const auto start1 = fifo.write(1);
+//        if (start1.blockSize1 > 0)
+//            buffers[(int)start1.startIndex1].makeCopyOf(buffer);
+//    }
+//
+//const juce::AudioBuffer<float>& AudioBufferQueue::getLatest()
+//    {
+//        const auto start1 = fifo.read(1);
+//        if (start1.blockSize1 > 0)
+//            return buffers[(int)start1.startIndex1];
+//        return dummy;
+//    }
+//
+
+
+template <typename SampleType>
+void FFTDataGenerator::pushSamples(const SampleType* samples, int numSamples)
+{
+    if (! active.load(std::memory_order_relaxed))
+        return;
+
+    int start1, size1, start2, size2;
+    ringFifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+    // converts on the way in for double
+    if (size1 > 0) std::copy(samples, samples + size1, ring + start1);
+    if (size2 > 0) std::copy(samples + size1, samples + size1 + size2, ring + start2);
+
+    ringFifo.finishedWrite(size1 + size2);
+}
+
+template void FFTDataGenerator::pushSamples(const float*, int);
+template void FFTDataGenerator::pushSamples(const double*, int);
+
+
+int FFTDataGenerator::useTimeSlice()
+{
+    int start1, size1, start2, size2;
+    ringFifo.prepareToRead(ringFifo.getNumReady(), start1, size1, start2, size2);
+
+    collectSamples(ring + start1, size1);
+    collectSamples(ring + start2, size2);
+
+    ringFifo.finishedRead(size1 + size2);
+
+    if (produceFFTData(frames.getWriteBuffer()))
+        frames.publish();
+
+    return 10; // ms until the next slice
+}
+
+
+void FFTDataGenerator::collectSamples(const float* samples, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        if (fifoIndex == fftSize)
+        {
+            memcpy(fftData, fifo, sizeof(fifo));
+            nextFFTBlockReady = true;
+            fifoIndex = 0;
+        }
+
+        fifo[fifoIndex++] = samples[i];
+    }
+}
+
+    // Do FFT and return magnitude bins in dB
+//bool FFTDataGenerator::produceFFTData(std::vector<float>& outputBins)
+//    {
+//        if (!nextFFTBlockReady) return false;
+//
+//        window.multiplyWithWindowingTable(fifo, fftSize); // Apply window
+//        memcpy(fftData, fifo, sizeof(fifo));
+//        forwardFFT.performFrequencyOnlyForwardTransform(fftData);
 //
 //        outputBins.clear();
 //        for (int i = 0; i < fftSize / 2; ++i)
@@ -699,17 +2221,37 @@ void FFTDataGenerator::pushSamples(const juce::AudioBuffer<float>& buffer)
 //        return true;
 //    }
 
-bool FFTDataGenerator::produceFFTData(std::vector<float>& outputBins)
+void FFTDataGenerator::attach()
+{
+    // reader side of the ring and the frames, nobody else is reading them right now
+    ringFifo.finishedRead(ringFifo.getNumReady());
+    fifoIndex = 0;
+    nextFFTBlockReady = false;
+
+    frames.acquire();
+    hasFrame = false;
+
+    active.store(true);
+}
+
+
+const AnalyserFrame* FFTDataGenerator::getLatestFrame()
+{
+    if (frames.acquire())
+        hasFrame = true;
+
+    return hasFrame ? &frames.getReadBuffer() : nullptr;
+}
+
+
+bool FFTDataGenerator::produceFFTData(AnalyserFrame& frame)
 {
     if (!nextFFTBlockReady) return false;
 
     window.multiplyWithWindowingTable(fftData, fftSize); // Only apply window here
     forwardFFT.performFrequencyOnlyForwardTransform(fftData);
 
-    
-    outputBins.clear();
-
-    const int desiredBins = 24;
+    const int desiredBins = AnalyserFrame::numBins;
     const int neighborhood = 0;
 
     float minFreq = 40.0f;
@@ -736,10 +2278,996 @@ bool FFTDataGenerator::produceFFTData(std::vector<float>& outputBins)
 
         float avgMag = sum / static_cast<float>(count);
         float db = juce::Decibels::gainToDecibels(avgMag, -100.0f);
-        outputBins.push_back(db);
+        frame.bins[(size_t) i] = db;
     }
 
     nextFFTBlockReady = false;
     return true;
 }
 
+
+
+//===================================================================================================================
+// SIMD MULTIBAND KERNEL
+//===================================================================================================================
+
+template <typename SampleType>
+typename SIMDMultiBandKernel<SampleType>::Vec SIMDMultiBandKernel<SampleType>::lanes(SampleType lowL, SampleType highL, SampleType lowR, SampleType highR)
+{
+    alignas(Vec::SIMDRegisterSize) SampleType values[numLanes] = { lowL, highL, lowR, highR };
+    return Vec::fromRawArray(values);
+}
+
+
+template <typename SampleType>
+void SIMDMultiBandKernel<SampleType>::prepare(double newSampleRate, int maxBlockSize)
+{
+    sampleRate = newSampleRate;
+
+    keepLow  = bands(1.0f, 0.0f);
+    keepHigh = bands(0.0f, 1.0f);
+
+    laneBuffer.setSize((int) numLanes, maxBlockSize);
+    oversampler.prepare(numLanes, maxBlockSize);
+
+    const int maxLookahead = (int) std::ceil(DownwardCompressor<SampleType>::maxLookaheadMs * 0.001 * sampleRate);
+    lookaheadMask = juce::nextPowerOfTwo(maxLookahead + 1) - 1;
+    lookaheadLine.assign((size_t) lookaheadMask + 1, Vec::expand(0.0f));
+    setLookahead(0);
+
+    upAttackCte  = Vec::expand(getBallisticsCoefficient(sampleRate, UpwardCompressor<SampleType>::attackMs));
+    upReleaseCte = Vec::expand(getBallisticsCoefficient(sampleRate, UpwardCompressor<SampleType>::releaseMs));
+
+    fadeSamples = juce::jmax(1, juce::roundToInt(DownwardCompressor<SampleType>::fadeMs * 0.001 * sampleRate));
+    compAmount = compAmountTarget = Vec::expand(1.0f);
+
+    crossoverFreq = -1.0f;
+    setCrossoverFrequency(1000.0f);
+    const distortionSettings neutralDistortion[] = { { 1.0f, 0.2f }, { 1.0f, 0.2f }, { 1.0f, 0.2f }, { 1.0f, 0.2f } };
+    const UpwardCompressorSettings neutralUpward[] = { { -60.0f, 1.5f }, { -60.0f, 1.5f }, { -60.0f, 1.5f }, { -60.0f, 1.5f } };
+    const CompressorSettings neutralCompressor[] = { { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } };
+
+    setMidSide(false);
+    setDistortion(0, neutralDistortion);
+    setCompressorMode(0);
+    setUpwardCompression(neutralUpward);
+    setCompressor(neutralCompressor, 1.0f, 50.0f);
+    setStereoLink(0.0f);
+    setHighCut(*juce::dsp::IIR::Coefficients<SampleType>::makeLowPass(sampleRate, (SampleType) 20000));
+    setOversampling(0, 0);
+
+    reset();
+}
+
+
+// outside a fade every lane's amount is 0 or 1
+template <typename Vec>
+static bool isAnyLaneOff(Vec amount)
+{
+    return amount.get(0) * amount.get(1) * amount.get(2) * amount.get(3) == 0.0f;
+}
+
+
+template <typename SampleType>
+void SIMDMultiBandKernel<SampleType>::reset()
+{
+    const auto zero = Vec::expand(0.0f);
+
+    signalSplit = { zero, zero, zero, zero };
+    keySplit = { zero, zero, zero, zero };
+    distEnvelope = zero;
+    compEnvelope = zero;
+    std::fill(&adaaX1[0][0], &adaaX1[0][0] + numLanes * 3, 0.0f);
+    adaaStale = true;
+
+    samplesUntilUpdate = 0;
+
+    upEnvelope = zero;
+    upGain = Vec::expand(2.0f); // no lift yet, just the fixed OTT +6 dB
+    upGainStep = zero;
+
+    compGain = Vec::expand(1.0f);
+    compGainStep = zero;
+    compAmount = compAmountTarget;
+    fadeRemaining = 0;
+    compBlend = isAnyLaneOff(compAmount);
+    std::fill(lookaheadLine.begin(), lookaheadLine.end(), zero);
+    lookaheadWrite = 0;
+    z1 = z2 = zero;
+}
+
+
+template <typename SampleType>
+void SIMDMultiBandKernel<SampleType>::setCrossoverFrequency(float frequency)
+{
+    if (frequency == crossoverFreq)
+        return;
+
+    crossoverFreq = frequency;
+
+    // same topology as juce::dsp::LinkwitzRileyFilter
+    const SampleType gain = std::tan(juce::MathConstants<SampleType>::pi * (SampleType) frequency / (SampleType) sampleRate);
+    g = Vec::expand(gain);
+    h = Vec::expand((SampleType) 1 / ((SampleType) 1 + juce::MathConstants<SampleType>::sqrt2 * gain + gain * gain));
+}
+
+
+template <typename SampleType>
+void SIMDMultiBandKernel<SampleType>::setMidSide(bool enabled)
+{
+    encodeLeft  = enabled ? lanes(0.5f, 0.5f, 0.5f, 0.5f)   : lanes(1.0f, 1.0f, 0.0f, 0.0f);
+    encodeRight = enabled ? lanes(0.5f, 0.5f, -0.5f, -0.5f) : lanes(0.0f, 0.0f, 1.0f, 1.0f);
+
+    sideToLeft  = enabled ? 1.0f : 0.0f;
+    midToRight  = enabled ? 1.0f : 0.0f;
+    sideToRight = enabled ? -1.0f : 1.0f;
+}
+
+
+template <typename SampleType>
+void SIMDMultiBandKernel<SampleType>::unpack(Vec x, SampleType& left, SampleType& right) const noexcept
+{
+    alignas(Vec::SIMDRegisterSize) SampleType frame[numLanes];
+    x.copyToRawArray(frame);
+
+    // Final mix, the band sums are L / R or M / S
+    const SampleType a = frame[0] + frame[1];
+    const SampleType b = frame[2] + frame[3];
+
+    left  = a + (SampleType) sideToLeft * b;
+    right = (SampleType) midToRight * a + (SampleType) sideToRight * b;
+}
+
+
+template <typename SampleType>
+void SIMDMultiBandKernel<SampleType>::setDistortion(int type, const distortionSettings* laneSettings)
+{
+    auto perLane = [laneSettings](auto f) { return lanes(f(laneSettings[0].drive), f(laneSettings[1].drive),
+                                                         f(laneSettings[2].drive), f(laneSettings[3].drive)); };
+
+    distType = type;
+    drive = perLane([](float d) { return d; });
+    crushScale = perLane([](float d) { return 1.0f / (1.0f + 0.3f * (d - 1.0f)); });
+
+    // same gain compensation curve as distortionDONT
+    dontGain = perLane([](float d) { return std::pow(juce::jmap(d, 1.0f, 7.0f, 0.5f, 0.1f), 1.3f); });
+}
+
+
+template <typename SampleType>
+void SIMDMultiBandKernel<SampleType>::setUpwardCompression(const UpwardCompressorSettings* laneSettings)
+{
+    for (size_t lane = 0; lane < numLanes; ++lane)
+        upComputers[lane].set(laneSettings[lane]);
+}
+
+
+template <typename SampleType>
+void SIMDMultiBandKernel<SampleType>::setCompressor(const CompressorSettings* laneSettings, float attackMs, float releaseMs)
+{
+    // the envelope picks the attack/release branch with a max(), that only holds while attack is the faster one
+    jassert(attackMs <= releaseMs);
+
+    // same conventions as juce::dsp::Compressor / BallisticsFilter
+    auto inverseThreshold = [](float thresholdDB) { return 1.0f / juce::Decibels::decibelsToGain(thresholdDB, -200.0f); };
+    auto cte = [this](float timeMs) { return getBallisticsCoefficient(sampleRate, timeMs); };
+
+    auto perLane = [laneSettings](auto f) { return lanes(f(laneSettings[0]), f(laneSettings[1]), f(laneSettings[2]), f(laneSettings[3])); };
+
+    compThresholdInv = perLane([&](const CompressorSettings& s) { return inverseThreshold(s.threshold); });
+    compExponent     = perLane([](const CompressorSettings& s) { return 1.0f / s.ratio - 1.0f; });
+    makeupGain       = perLane([](const CompressorSettings& s) { return juce::Decibels::decibelsToGain(s.makeupGain); });
+
+    attackCte  = Vec::expand(cte(attackMs));
+    releaseCte = Vec::expand(cte(releaseMs));
+
+    // lanes switching between compressing and identity fade, a lane coming back from off starts from a reset detector
+    const Vec target = perLane([](const CompressorSettings& s) { return s.ratio < DownwardCompressor<SampleType>::identityRatio ? 0.0f : 1.0f; });
+    bool changed = false, anyOn = false;
+
+    for (size_t lane = 0; lane < numLanes; ++lane)
+    {
+        anyOn |= target.get(lane) > 0.0f;
+
+        if (target.get(lane) == compAmountTarget.get(lane))
+            continue;
+
+        changed = true;
+
+        if (target.get(lane) > 0.0f && compAmount.get(lane) == 0.0f)
+        {
+            compEnvelope.set(lane, 0.0f);
+            compGain.set(lane, 1.0f);
+            compGainStep.set(lane, 0.0f);
+        }
+    }
+
+    compIdentity = ! anyOn;
+
+    if (! changed)
+        return;
+
+    compAmountTarget = target;
+    compAmountStep = (target - compAmount) * Vec::expand((SampleType) 1 / (SampleType) fadeSamples);
+    fadeRemaining = fadeSamples;
+    compBlend = true;
+}
+
+
+template <typename SampleType>
+void SIMDMultiBandKernel<SampleType>::setHighCut(const juce::dsp::IIR::Coefficients<SampleType>& coefficients)
+{
+    // raw layout of a normalised biquad: b0, b1, b2, a1, a2
+    const SampleType* c = coefficients.getRawCoefficients();
+
+    b0 = Vec::expand(c[0]);
+    b1 = Vec::expand(c[1]);
+    b2 = Vec::expand(c[2]);
+    a1 = Vec::expand(c[3]);
+    a2 = Vec::expand(c[4]);
+}
+
+
+template <typename SampleType>
+void SIMDMultiBandKernel<SampleType>::setOversampling(int factorIndex, int filterMode)
+{
+    oversampler.select(factorIndex, filterMode);
+
+    // keep the CRUSH / DON'T envelope time constant independent of the rate it runs at
+    distAlpha = DistortionState<SampleType>::envelopeAlpha / (float) oversampler.getFactor();
+}
+
+
+template <typename SampleType>
+typename SIMDMultiBandKernel<SampleType>::Vec SIMDMultiBandKernel<SampleType>::gather(SampleType* const* channels, int index)
+{
+    return lanes(channels[0][index], channels[1][index], channels[2][index], channels[3][index]);
+}
+
+
+template <typename SampleType>
+void SIMDMultiBandKernel<SampleType>::scatter(Vec x, SampleType* const* channels, int index)
+{
+    alignas(Vec::SIMDRegisterSize) SampleType frame[numLanes];
+    x.copyToRawArray(frame);
+
+    for (size_t lane = 0; lane < numLanes; ++lane)
+        channels[lane][index] = frame[lane];
+}
+
+
+// the table lookups are gathers, so they go per lane (the tables are float, in either precision)
+template <typename SampleType>
+typename SIMDMultiBandKernel<SampleType>::Vec SIMDMultiBandKernel<SampleType>::shapeWarm(Vec x, Vec laneDrive)
+{
+    for (size_t i = 0; i < numLanes; ++i)
+        x.set(i, (SampleType) tables->warm((float) x.get(i), (float) laneDrive.get(i)));
+
+    return x;
+}
+
+
+// tanh(drive * WARM(x, drive))
+template <typename SampleType>
+typename SIMDMultiBandKernel<SampleType>::Vec SIMDMultiBandKernel<SampleType>::shapeCore(Vec x, Vec laneDrive)
+{
+    for (size_t i = 0; i < numLanes; ++i)
+        x.set(i, (SampleType) tables->crushCore((float) x.get(i), (float) laneDrive.get(i)));
+
+    return x;
+}
+
+
+template <typename SampleType>
+typename SIMDMultiBandKernel<SampleType>::Vec SIMDMultiBandKernel<SampleType>::tanh(Vec x)
+{
+    if constexpr (std::is_same_v<Vec, juce::dsp::SIMDRegister<float>>)
+    {
+        return fastTanh::tanh(x);
+    }
+    else
+    {
+        for (size_t i = 0; i < numLanes; ++i)
+            x.set(i, (SampleType) fastTanh::tanh((float) x.get(i)));
+
+        return x;
+    }
+}
+
+
+template <typename SampleType>
+template <int DistType, bool ADAA>
+typename SIMDMultiBandKernel<SampleType>::Vec SIMDMultiBandKernel<SampleType>::distort(Vec x)
+{
+    Vec dynamicDrive = drive;
+
+    // CRUSH / DON'T: envelope driven drive, every lane has its own envelope (same as DistortionState)
+    if constexpr (DistType != 0)
+    {
+        distEnvelope = distEnvelope * (1.0f - distAlpha) + Vec::abs(x) * distAlpha;
+        dynamicDrive = (DistType == 1 ? drive : drive * drive) * (Vec::expand(1.0f) + distEnvelope * 0.5f);
+    }
+
+    if constexpr (ADAA)
+    {
+        // antiderivatives have no cheap vector form, so the cascade runs per lane
+        const bool prime = adaaStale;
+        adaaStale = false;
+
+        for (size_t lane = 0; lane < numLanes; ++lane)
+            x.set(lane, curveADAA(x.get(lane), adaaX1[lane], DistType, (float) dynamicDrive.get(lane),
+                                  (float) crushScale.get(lane), (float) dontGain.get(lane), prime));
+
+        return x;
+    }
+    else if constexpr (DistType == 0)
+    {
+        return shapeWarm(x, drive);
+    }
+    else if constexpr (DistType == 1)
+    {
+        return crushScale * shapeCore(x, dynamicDrive);
+    }
+    else
+    {
+        const Vec saturated = crushScale * shapeCore(x, dynamicDrive);
+        return tanh(dynamicDrive * dynamicDrive * saturated) * dontGain;
+    }
+}
+
+
+template <typename SampleType>
+typename SIMDMultiBandKernel<SampleType>::Vec SIMDMultiBandKernel<SampleType>::split(Vec x, SplitState& state)
+{
+    const Vec R2 = Vec::expand(juce::MathConstants<SampleType>::sqrt2);
+    auto& [s1, s2, s3, s4] = state;
+
+    Vec yH = (x - (R2 + g) * s1 - s2) * h;
+    Vec yB = g * yH + s1;
+    s1 = g * yH + yB;
+    Vec yL = g * yB + s2;
+    s2 = g * yB + yL;
+
+    Vec yH2 = (yL - (R2 + g) * s3 - s4) * h;
+    Vec yB2 = g * yH2 + s3;
+    s3 = g * yH2 + yB2;
+    Vec yL2 = g * yB2 + s4;
+    s4 = g * yB2 + yL2;
+
+    Vec lowOut  = yL2;
+    Vec highOut = yL - R2 * yB + yH - yL2;
+    return lowOut * keepLow + highOut * keepHigh;
+}
+
+
+// each lane's detector level pulled towards the same band of the other channel, { A low, A high } <-> { B low, B high }
+template <typename SampleType>
+typename SIMDMultiBandKernel<SampleType>::Vec SIMDMultiBandKernel<SampleType>::linkLevels(Vec level) const noexcept
+{
+    alignas(Vec::SIMDRegisterSize) SampleType frame[numLanes];
+    level.copyToRawArray(frame);
+
+    const Vec louder = Vec::max(level, lanes(frame[2], frame[3], frame[0], frame[1]));
+    return level + stereoLink * (louder - level);
+}
+
+
+template <typename SampleType>
+template <int CompMode, bool Keyed, bool Linked>
+typename SIMDMultiBandKernel<SampleType>::Vec SIMDMultiBandKernel<SampleType>::dynamics(Vec x, Vec key)
+{
+    const Vec one = Vec::expand(1.0f);
+
+    if constexpr (CompMode == dynamicsOff)
+    {
+        // the delay still has to be there, the other bands / the dry path are lined up with it
+        lookaheadLine[(size_t) lookaheadWrite] = x;
+        const Vec delayed = lookaheadLine[(size_t) ((lookaheadWrite - lookahead) & lookaheadMask)];
+        lookaheadWrite = (lookaheadWrite + 1) & lookaheadMask;
+
+        return delayed * makeupGain;
+    }
+
+    // detectors run every sample, the gains only get a new target every controlInterval samples
+    const bool updateGains = --samplesUntilUpdate <= 0;
+    const SampleType rampScale = (SampleType) 1 / (SampleType) controlInterval;
+
+    if (updateGains)
+        samplesUntilUpdate = controlInterval;
+
+    // Upward Compression (OTT): same detector as the downward one
+    if constexpr (CompMode == 2)
+    {
+        Vec upLevel = Vec::abs(x);
+        if constexpr (Linked)
+            upLevel = linkLevels(upLevel);
+
+        upEnvelope = Vec::max(upLevel + upAttackCte  * (upEnvelope - upLevel),
+                              upLevel + upReleaseCte * (upEnvelope - upLevel));
+
+        if (updateGains)
+        {
+            Vec target;
+            for (size_t lane = 0; lane < numLanes; ++lane)
+                target.set(lane, upComputers[lane].getGain(upEnvelope.get(lane)));
+
+            upGainStep = (target - upGain) * rampScale;
+        }
+
+        upGain += upGainStep;
+        x *= upGain;
+    }
+
+    // Downward Compression: peak envelope, attack <= release so the right branch is the larger one
+    Vec level = Vec::abs(Keyed ? key : x);
+    if constexpr (Linked)
+        level = linkLevels(level);
+
+    compEnvelope = Vec::max(level + attackCte  * (compEnvelope - level),
+                            level + releaseCte * (compEnvelope - level));
+
+    if (updateGains)
+    {
+        Vec target = Vec::max(one, compEnvelope * compThresholdInv);
+        for (size_t lane = 0; lane < numLanes; ++lane)
+            target.set(lane, std::pow(target.get(lane), compExponent.get(lane)));
+
+        compGainStep = (target - compGain) * rampScale;
+    }
+
+    compGain += compGainStep;
+    Vec gain = compGain;
+
+    // lanes on their way in or out, or switched off next to ones that aren't
+    if (compBlend)
+    {
+        if (fadeRemaining > 0 && --fadeRemaining == 0)
+        {
+            compAmount = compAmountTarget;
+            compBlend = isAnyLaneOff(compAmount);
+        }
+        else if (fadeRemaining > 0)
+        {
+            compAmount += compAmountStep;
+        }
+
+        gain = one + compAmount * (compGain - one);
+    }
+
+    // Lookahead: the gain follows x, it lands on x from lookahead samples ago
+    lookaheadLine[(size_t) lookaheadWrite] = x;
+    const Vec delayed = lookaheadLine[(size_t) ((lookaheadWrite - lookahead) & lookaheadMask)];
+    lookaheadWrite = (lookaheadWrite + 1) & lookaheadMask;
+
+    // Makeup Gain
+    return delayed * gain * makeupGain;
+}
+
+
+template <typename SampleType>
+typename SIMDMultiBandKernel<SampleType>::Vec SIMDMultiBandKernel<SampleType>::highCut(Vec x)
+{
+    Vec y = b0 * x + z1;
+    z1 = b1 * x - a1 * y + z2;
+    z2 = b2 * x - a2 * y;
+    return y;
+}
+
+
+template <typename SampleType>
+void SIMDMultiBandKernel<SampleType>::process(SampleType* left, SampleType* right, int numSamples, const SampleType* keyLeft, const SampleType* keyRight)
+{
+    using Kernel = void (SIMDMultiBandKernel::*)(SampleType*, SampleType*, const SampleType*, const SampleType*, int);
+
+    // [ADAA][distortion type][compressor mode], the last mode is dynamicsOff
+    static constexpr Kernel kernels[2][3][4] =
+    {
+        {
+            { &SIMDMultiBandKernel<SampleType>::processAs<0, 0, false>, &SIMDMultiBandKernel<SampleType>::processAs<0, 1, false>, &SIMDMultiBandKernel<SampleType>::processAs<0, 2, false>, &SIMDMultiBandKernel<SampleType>::processAs<0, dynamicsOff, false> },
+            { &SIMDMultiBandKernel<SampleType>::processAs<1, 0, false>, &SIMDMultiBandKernel<SampleType>::processAs<1, 1, false>, &SIMDMultiBandKernel<SampleType>::processAs<1, 2, false>, &SIMDMultiBandKernel<SampleType>::processAs<1, dynamicsOff, false> },
+            { &SIMDMultiBandKernel<SampleType>::processAs<2, 0, false>, &SIMDMultiBandKernel<SampleType>::processAs<2, 1, false>, &SIMDMultiBandKernel<SampleType>::processAs<2, 2, false>, &SIMDMultiBandKernel<SampleType>::processAs<2, dynamicsOff, false> }
+        },
+        {
+            { &SIMDMultiBandKernel<SampleType>::processAs<0, 0, true>, &SIMDMultiBandKernel<SampleType>::processAs<0, 1, true>, &SIMDMultiBandKernel<SampleType>::processAs<0, 2, true>, &SIMDMultiBandKernel<SampleType>::processAs<0, dynamicsOff, true> },
+            { &SIMDMultiBandKernel<SampleType>::processAs<1, 0, true>, &SIMDMultiBandKernel<SampleType>::processAs<1, 1, true>, &SIMDMultiBandKernel<SampleType>::processAs<1, 2, true>, &SIMDMultiBandKernel<SampleType>::processAs<1, dynamicsOff, true> },
+            { &SIMDMultiBandKernel<SampleType>::processAs<2, 0, true>, &SIMDMultiBandKernel<SampleType>::processAs<2, 1, true>, &SIMDMultiBandKernel<SampleType>::processAs<2, 2, true>, &SIMDMultiBandKernel<SampleType>::processAs<2, dynamicsOff, true> }
+        }
+    };
+
+    // OTT always runs its upward stage, the others can drop the detectors once every lane has faded out
+    const int mode = compMode != 2 && compIdentity && fadeRemaining == 0 ? dynamicsOff : compMode;
+
+    (this->*kernels[adaaEnabled ? 1 : 0][juce::jlimit(0, 2, distType)][mode])(left, right, keyLeft, keyRight, numSamples);
+}
+
+
+template <typename SampleType>
+template <int DistType, int CompMode, bool ADAA>
+void SIMDMultiBandKernel<SampleType>::processAs(SampleType* left, SampleType* right, const SampleType* keyLeft, const SampleType* keyRight, int numSamples)
+{
+    const bool keyed = keyLeft != nullptr && keyRight != nullptr;
+    const bool linked = linkAmount > 0.0f;
+
+    if (keyed)
+    {
+        if (linked) processWith<DistType, CompMode, ADAA, true, true>(left, right, keyLeft, keyRight, numSamples);
+        else        processWith<DistType, CompMode, ADAA, true, false>(left, right, keyLeft, keyRight, numSamples);
+    }
+    else
+    {
+        if (linked) processWith<DistType, CompMode, ADAA, false, true>(left, right, nullptr, nullptr, numSamples);
+        else        processWith<DistType, CompMode, ADAA, false, false>(left, right, nullptr, nullptr, numSamples);
+    }
+}
+
+
+template <typename SampleType>
+template <int DistType, int CompMode, bool ADAA, bool Keyed, bool Linked>
+void SIMDMultiBandKernel<SampleType>::processWith(SampleType* left, SampleType* right, const SampleType* keyLeft, const SampleType* keyRight, int numSamples)
+{
+    auto* os = oversampler.getActive();
+
+    if (os == nullptr)
+    {
+        processFused<DistType, CompMode, ADAA, Keyed, Linked>(left, right, keyLeft, keyRight, numSamples);
+        return;
+    }
+
+    const int maxChunk = laneBuffer.getNumSamples();
+
+    for (int start = 0; start < numSamples; start += maxChunk)
+    {
+        const int chunk = juce::jmin(maxChunk, numSamples - start);
+
+        if constexpr (Keyed)
+            processOversampled<DistType, CompMode, ADAA, Keyed, Linked>(*os, left + start, right + start, keyLeft + start, keyRight + start, chunk);
+        else
+            processOversampled<DistType, CompMode, ADAA, Keyed, Linked>(*os, left + start, right + start, nullptr, nullptr, chunk);
+    }
+}
+
+
+// 1x: every stage back to back on one register per sample
+template <typename SampleType>
+template <int DistType, int CompMode, bool ADAA, bool Keyed, bool Linked>
+void SIMDMultiBandKernel<SampleType>::processFused(SampleType* left, SampleType* right, const SampleType* keyLeft, const SampleType* keyRight, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        Vec x = split(pack(left[i], right[i]), signalSplit);
+        x = distort<DistType, ADAA>(x);
+
+        // the key only goes through the same split, nothing else
+        Vec key = x;
+        if constexpr (Keyed)
+            key = split(pack(keyLeft[i], keyRight[i]), keySplit);
+
+        x = dynamics<CompMode, Keyed, Linked>(x, key);
+        unpack(highCut(x), left[i], right[i]);
+    }
+}
+
+
+// Oversampled: split into the planar lane buffer, run only the distortion at the higher rate
+template <typename SampleType>
+template <int DistType, int CompMode, bool ADAA, bool Keyed, bool Linked>
+void SIMDMultiBandKernel<SampleType>::processOversampled(juce::dsp::Oversampling<SampleType>& os, SampleType* left, SampleType* right,
+                                                         const SampleType* keyLeft, const SampleType* keyRight, int numSamples)
+{
+    auto* const* laneData = laneBuffer.getArrayOfWritePointers();
+
+    // Crossover
+    for (int i = 0; i < numSamples; ++i)
+        scatter(split(pack(left[i], right[i]), signalSplit), laneData, i);
+
+    // Distortion
+    auto block = juce::dsp::AudioBlock<SampleType>(laneBuffer).getSubBlock(0, (size_t) numSamples);
+    auto upBlock = os.processSamplesUp(block);
+
+    SampleType* upData[numLanes];
+    for (size_t lane = 0; lane < numLanes; ++lane)
+        upData[lane] = upBlock.getChannelPointer(lane);
+
+    for (int i = 0; i < (int) upBlock.getNumSamples(); ++i)
+        scatter(distort<DistType, ADAA>(gather(upData, i)), upData, i);
+
+    os.processSamplesDown(block);
+
+    // Dynamics (key split at the host rate), High Cut, Final mix
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const Vec x = gather(laneData, i);
+
+        Vec key = x;
+        if constexpr (Keyed)
+            key = split(pack(keyLeft[i], keyRight[i]), keySplit);
+
+        unpack(highCut(dynamics<CompMode, Keyed, Linked>(x, key)), left[i], right[i]);
+    }
+}
+
+
+template class SIMDMultiBandKernel<float>;
+template class SIMDMultiBandKernel<double>;
+
+
+
+
+//===================================================================================================================
+// N-BAND CROSSOVER
+//===================================================================================================================
+
+template <typename SampleType>
+void CrossoverTree<SampleType>::prepare(double newSampleRate, int newNumChannels)
+{
+    sampleRate = newSampleRate;
+    numChannels = newNumChannels;
+
+    for (auto* state : { &s1, &s2, &s3, &s4 })
+        state->resize((size_t) (maxSplits * numChannels));
+
+    for (auto* state : { &ap1, &ap2 })
+        state->resize((size_t) (maxSplits * maxBands * numChannels));
+
+    // forces setSplits to recompute every split
+    std::fill(std::begin(frequency), std::end(frequency), -1.0f);
+
+    reset();
+}
+
+
+template <typename SampleType>
+void CrossoverTree<SampleType>::reset()
+{
+    for (auto* state : { &s1, &s2, &s3, &s4, &ap1, &ap2 })
+        std::fill(state->begin(), state->end(), (SampleType) 0);
+}
+
+
+template <typename SampleType>
+void CrossoverTree<SampleType>::setSplits(int newNumBands, const float* frequencies)
+{
+    newNumBands = juce::jlimit(2, maxBands, newNumBands);
+
+    if (newNumBands != numBands)
+    {
+        numBands = newNumBands;
+        reset();
+    }
+
+    for (int split = 0; split < numBands - 1; ++split)
+    {
+        const float f = juce::jmin(frequencies[split], (float) (sampleRate * 0.49));
+
+        if (f == frequency[split])
+            continue;
+
+        frequency[split] = f;
+
+        const SampleType gain = std::tan(juce::MathConstants<SampleType>::pi * (SampleType) f / (SampleType) sampleRate);
+        g[split] = gain;
+        h[split] = (SampleType) 1 / ((SampleType) 1 + juce::MathConstants<SampleType>::sqrt2 * gain + gain * gain);
+    }
+}
+
+
+template <typename SampleType>
+void CrossoverTree<SampleType>::process(int channel, const SampleType* input, SampleType* const* bandData, int numSamples) noexcept
+{
+    const SampleType R2 = juce::MathConstants<SampleType>::sqrt2;
+    const int numSplits = numBands - 1;
+
+    // whatever is above the splits done so far, the last split leaves the top band in it
+    SampleType* rest = bandData[numSplits];
+
+    if (rest != input)
+        juce::FloatVectorOperations::copy(rest, input, numSamples);
+
+    for (int split = 0; split < numSplits; ++split)
+    {
+        SampleType* low = bandData[split];
+        const SampleType gk = g[split], hk = h[split];
+        const size_t index = splitIndex(split, channel);
+        SampleType z1 = s1[index], z2 = s2[index], z3 = s3[index], z4 = s4[index];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const SampleType x = rest[i];
+
+            const SampleType yH = (x - (R2 + gk) * z1 - z2) * hk;
+            const SampleType yB = gk * yH + z1;
+            z1 = gk * yH + yB;
+            const SampleType yL = gk * yB + z2;
+            z2 = gk * yB + yL;
+
+            const SampleType yH2 = (yL - (R2 + gk) * z3 - z4) * hk;
+            const SampleType yB2 = gk * yH2 + z3;
+            z3 = gk * yH2 + yB2;
+            const SampleType yL2 = gk * yB2 + z4;
+            z4 = gk * yB2 + yL2;
+
+            low[i]  = yL2;
+            rest[i] = yL - R2 * yB + yH - yL2;
+        }
+
+        s1[index] = z1;
+        s2[index] = z2;
+        s3[index] = z3;
+        s4[index] = z4;
+
+        // the bands already peeled off never saw this split, give them its phase
+        for (int band = 0; band < split; ++band)
+            compensate(split, band, channel, bandData[band], numSamples);
+    }
+}
+
+
+// LP + HP of an LR4 is the 2nd order allpass of the split's SVF: yL - sqrt2 yB + yH = x - 2 sqrt2 yB
+template <typename SampleType>
+void CrossoverTree<SampleType>::compensate(int split, int band, int channel, SampleType* data, int numSamples) noexcept
+{
+    const SampleType R2 = juce::MathConstants<SampleType>::sqrt2;
+    const SampleType gk = g[split], hk = h[split];
+    const size_t index = allpassIndex(split, band, channel);
+    SampleType z1 = ap1[index], z2 = ap2[index];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const SampleType x = data[i];
+
+        const SampleType yH = (x - (R2 + gk) * z1 - z2) * hk;
+        const SampleType yB = gk * yH + z1;
+        z1 = gk * yH + yB;
+        const SampleType yL = gk * yB + z2;
+        z2 = gk * yB + yL;
+
+        data[i] = x - (SampleType) 2 * R2 * yB;
+    }
+
+    ap1[index] = z1;
+    ap2[index] = z2;
+}
+
+
+template class CrossoverTree<float>;
+template class CrossoverTree<double>;
+
+
+
+
+//===================================================================================================================
+// DISTORTION OVERSAMPLING
+//===================================================================================================================
+
+template <typename SampleType>
+void DistortionOversampler<SampleType>::prepare(size_t numChannels, int maxBlockSize)
+{
+    using OS = juce::dsp::Oversampling<SampleType>;
+    const typename OS::FilterType filterTypes[2] = { OS::filterHalfBandPolyphaseIIR, OS::filterHalfBandFIREquiripple };
+
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        for (int factor = 1; factor < numFactors; ++factor)
+        {
+            // integer latency so the host gets told the exact delay
+            auto& os = oversamplers[mode][factor - 1];
+            os = std::make_unique<OS>(numChannels, (size_t) factor, filterTypes[mode], true, true);
+            os->initProcessing((size_t) maxBlockSize);
+        }
+    }
+
+    active = nullptr;
+}
+
+
+template <typename SampleType>
+void DistortionOversampler<SampleType>::select(int factorIndex, int filterMode)
+{
+    factorIndex = juce::jlimit(0, numFactors - 1, factorIndex);
+    filterMode  = juce::jlimit(0, 1, filterMode);
+
+    auto* next = factorIndex > 0 ? oversamplers[filterMode][factorIndex - 1].get() : nullptr;
+
+    // the one we switch to still holds whatever it saw last time it was active
+    if (next != nullptr && next != active)
+        next->reset();
+
+    active = next;
+}
+
+
+template <typename SampleType>
+int DistortionOversampler<SampleType>::getLatencySamples() const noexcept
+{
+    return active != nullptr ? juce::roundToInt(active->getLatencyInSamples()) : 0;
+}
+
+
+template <typename SampleType>
+void DistortionOversampler<SampleType>::reset()
+{
+    if (active != nullptr)
+        active->reset();
+}
+
+
+template <typename SampleType>
+int DistortionOversampler<SampleType>::getMaxLatencySamples() const noexcept
+{
+    int latency = 0;
+
+    for (auto& mode : oversamplers)
+        for (auto& os : mode)
+            if (os != nullptr)
+                latency = juce::jmax(latency, juce::roundToInt(os->getLatencyInSamples()));
+
+    return latency;
+}
+
+
+template class DistortionOversampler<float>;
+template class DistortionOversampler<double>;
+
+
+//==============================================================================
+// DRY / WET
+//==============================================================================
+
+template <typename SampleType>
+void DryWetMix<SampleType>::prepare(double sampleRate, int newNumChannels, int maxBlockSize, int maxLatency)
+{
+    numChannels = juce::jmax(0, newNumChannels);
+    maxLatencySamples = juce::jmax(0, maxLatency);
+    size = juce::nextPowerOfTwo(maxLatencySamples + maxBlockSize);
+    lines.assign((size_t) (numChannels * size), (SampleType) 0);
+
+    wet.reset(sampleRate, smoothingSeconds);
+    processed.reset(sampleRate, smoothingSeconds);
+    latency = juce::jmin(latency, maxLatencySamples);
+    reset();
+}
+
+
+template <typename SampleType>
+void DryWetMix<SampleType>::reset()
+{
+    std::fill(lines.begin(), lines.end(), (SampleType) 0);
+    writePosition = 0;
+    wet.setCurrentAndTargetValue(wet.getTargetValue());
+    processed.setCurrentAndTargetValue(processed.getTargetValue());
+}
+
+
+template <typename SampleType>
+void DryWetMix<SampleType>::pushDry(const SampleType* const* channelData, int numChannelsToPush, int numSamples) noexcept
+{
+    numChannelsToPush = juce::jmin(numChannelsToPush, numChannels);
+    const int mask = size - 1;
+
+    // at most two runs, the ring wraps at most once per block
+    const int first = juce::jmin(numSamples, size - writePosition);
+
+    for (int channel = 0; channel < numChannelsToPush; ++channel)
+    {
+        SampleType* line = lines.data() + channel * size;
+        std::copy(channelData[channel], channelData[channel] + first, line + writePosition);
+        std::copy(channelData[channel] + first, channelData[channel] + numSamples, line);
+    }
+
+    writePosition = (writePosition + numSamples) & mask;
+}
+
+
+template <typename SampleType>
+void DryWetMix<SampleType>::mixWet(SampleType* const* channelData, int numChannelsToMix, int numSamples) noexcept
+{
+    // fully wet and staying there: the dry line only had to be kept filled
+    if (! wet.isSmoothing() && wet.getTargetValue() >= 1.0f)
+        return;
+
+    numChannelsToMix = juce::jmin(numChannelsToMix, numChannels);
+    const int mask = size - 1;
+
+    // pushDry already moved writePosition past this block
+    const int readStart = writePosition - numSamples - latency;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float wetGain = wet.getNextValue();
+        const int read = (readStart + i) & mask;
+
+        for (int channel = 0; channel < numChannelsToMix; ++channel)
+        {
+            const SampleType dry = lines[(size_t) (channel * size + read)];
+            channelData[channel][i] = dry + (SampleType) wetGain * (channelData[channel][i] - dry);
+        }
+    }
+}
+
+
+template <typename SampleType>
+void DryWetMix<SampleType>::fadeBypass(SampleType* const* channelData, int numChannelsToFade, int numSamples, int extraLatency) noexcept
+{
+    // not bypassed and not on the way there
+    if (! processed.isSmoothing() && processed.getTargetValue() == 1.0f)
+        return;
+
+    numChannelsToFade = juce::jmin(numChannelsToFade, numChannels);
+    const int mask = size - 1;
+    const int readStart = writePosition - numSamples - juce::jmin(maxLatencySamples, latency + extraLatency);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float gain = processed.getNextValue();
+        const int read = (readStart + i) & mask;
+
+        for (int channel = 0; channel < numChannelsToFade; ++channel)
+        {
+            // fully bypassed the buffer still holds the unprocessed input, so it's not used at all
+            const SampleType dry = lines[(size_t) (channel * size + read)];
+            channelData[channel][i] = gain == 0.0f ? dry : dry + (SampleType) gain * (channelData[channel][i] - dry);
+        }
+    }
+}
+
+
+template class DryWetMix<float>;
+template class DryWetMix<double>;
+
+
+//==============================================================================
+// SIDECHAIN KEY DELAY
+
+template <typename SampleType>
+void KeyDelay<SampleType>::prepare(int numChannels, int maxDelay)
+{
+    maxChannels = juce::jmax(0, numChannels);
+    size = juce::nextPowerOfTwo(juce::jmax(0, maxDelay) + 1);
+    lines.assign((size_t) (maxChannels * size), (SampleType) 0);
+    delay = juce::jmin(delay, size - 1);
+    reset();
+}
+
+
+template <typename SampleType>
+void KeyDelay<SampleType>::reset()
+{
+    std::fill(lines.begin(), lines.end(), (SampleType) 0);
+    writePosition = 0;
+    lastNumChannels = 0;
+}
+
+
+template <typename SampleType>
+void KeyDelay<SampleType>::process(SampleType* const* channelData, int numChannels, int numSamples) noexcept
+{
+    numChannels = juce::jmin(numChannels, maxChannels);
+
+    if (numChannels != lastNumChannels)
+    {
+        std::fill(lines.begin(), lines.end(), (SampleType) 0);
+        lastNumChannels = numChannels;
+    }
+
+    const int mask = size - 1;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        SampleType* line = lines.data() + channel * size;
+        SampleType* data = channelData[channel];
+        int write = writePosition;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            line[write] = data[i];
+            data[i] = line[(write - delay) & mask];
+            write = (write + 1) & mask;
+        }
+    }
+
+    writePosition = (writePosition + numSamples) & mask;
+}
+
+
+template class KeyDelay<float>;
+template class KeyDelay<double>;
@@ -10,14 +10,34 @@
 
 #include <JuceHeader.h>
 #include "frequencyLines.h"
+#include "analyserFrame.h"
+#include "fastTanh.h"
+#include "waveshaperTables.h"
+#include "linearPhaseCrossover.h"
+#include "truePeakLimiter.h"
 // Extract Parameters
 
 
 // A structure containing all the parameters of the plugin
+// (compressorSpeed / distortionType hold the snapped mode: 0 = GLUE/WARM, 1 = TAME/CRUSH, 2 = OTT/DON'T)
 struct ChainSettings
 {
     float bandsplit_frequency {0},  compLowIntensity {0}, compHighIntensity {0}, distLowIntensity {0}, distHighIntensity {0}, highCutFreq {0};
+    int numBands {2};
+    float bandsplit_frequency_2 {0}, bandsplit_frequency_3 {0}, bandsplit_frequency_4 {0}; // only the first numBands - 1 splits are used
+    int crossoverMode {0}; // 0 = minimum phase (LR tree), 1 = linear phase (FIR)
+    bool midSide {false};  // channels 0 / 1 run as mid / side, the side gets its own intensities
+    float compLowIntensitySide {0}, compHighIntensitySide {0}, distLowIntensitySide {0}, distHighIntensitySide {0};
     int compressorSpeed {0}, distortionType {0} ;
+    int oversamplingFactor {0}, oversamplingFilter {0}; // factor index: 0 = 1x, 1 = 2x, 2 = 4x, 3 = 8x
+    bool distortionADAA {false};
+    int compressorControlInterval {1}; // samples between compressor gain updates
+    float stereoLink {0};              // 0 = every channel detects on its own, 1 = one detector per band and pair
+    float lookaheadMs {0};             // downward compressors only
+    bool truePeakCeiling {false};
+    float ceilingDB {-1.0f};
+    bool externalSidechain {false};    // key the downward detectors from the sidechain bus, band by band
+    float mix {1.0f};                  // 0 = dry, 1 = wet
     //float lowCutFreq{0}, highCutFreq{0};
     
     //Slope lowCutSlope{Slope::Slope_12},  highCutSlope{Slope::Slope_12};
@@ -41,13 +61,79 @@ struct UpwardCompressorSettings
     float ratio;
 };
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+// Everything the distortion remembers for one band of one channel, owned by the processor
+// (the SIMD kernel keeps the same fields as lanes of its own registers)
+template <typename SampleType>
+struct DistortionState
+{
+    SampleType envelope = 0; // CRUSH / DON'T drive envelope
+    
+    // the envelope's one pole coefficient at the host rate, runs at the oversampled rate divided by the factor
+    static constexpr float envelopeAlpha = 0.001f;
+    
+    // ADAA: the curves are cascades of up to three stages (WARM -> tanh -> tanh), x1 holds each stage's previous input.
+    // Only kept up while ADAA is on, so after switching it on (or a reset) the first sample primes them
+    SampleType x1[3] = { 0, 0, 0 };
+    bool adaaPrimed = false;
+    
+    void reset() { *this = DistortionState(); }
+};
+
+int getCompressorSpeedMode(float rawValue);
+int getDistortionType(float rawValue);
+
+// One pole smoothing coefficient for an attack / release time, same convention as juce::dsp::BallisticsFilter
+float getBallisticsCoefficient(double sampleRate, float timeMs);
+
+// "compressorControlRate" choice index -> samples between gain updates
+int getCompressorControlInterval(float rawValue);
+
+
+// Raw parameter values, resolved once so the audio thread never does a string lookup
+struct ParameterPointers
+{
+    std::atomic<float>* bandsplitFrequency = nullptr;
+    std::atomic<float>* compLowIntensity = nullptr;
+    std::atomic<float>* compHighIntensity = nullptr;
+    std::atomic<float>* compressorSpeed = nullptr;
+    std::atomic<float>* distLowIntensity = nullptr;
+    std::atomic<float>* distHighIntensity = nullptr;
+    std::atomic<float>* distortionType = nullptr;
+    std::atomic<float>* highCutFreq = nullptr;
+    std::atomic<float>* oversamplingFactor = nullptr;
+    std::atomic<float>* oversamplingFilter = nullptr;
+    std::atomic<float>* distortionADAA = nullptr;
+    std::atomic<float>* compressorControlRate = nullptr;
+    std::atomic<float>* stereoLink = nullptr;
+    std::atomic<float>* lookahead = nullptr;
+    std::atomic<float>* truePeakCeiling = nullptr;
+    std::atomic<float>* ceiling = nullptr;
+    std::atomic<float>* externalSidechain = nullptr;
+    std::atomic<float>* mix = nullptr;
+    std::atomic<float>* numBands = nullptr;
+    std::atomic<float>* bandsplitFrequency2 = nullptr;
+    std::atomic<float>* bandsplitFrequency3 = nullptr;
+    std::atomic<float>* bandsplitFrequency4 = nullptr;
+    std::atomic<float>* crossoverMode = nullptr;
+    std::atomic<float>* stereoMode = nullptr;
+    std::atomic<float>* compLowIntensitySide = nullptr;
+    std::atomic<float>* compHighIntensitySide = nullptr;
+    std::atomic<float>* distLowIntensitySide = nullptr;
+    std::atomic<float>* distHighIntensitySide = nullptr;
+
+    void resolve(juce::AudioProcessorValueTreeState& apvts);
+
+    // Immutable per-block snapshot
+    ChainSettings load() const;
+};
 
 
 
 
 
-class FFTDataGenerator
+// Spectrum analyser. The audio thread only pushes samples into a wait-free SPSC ring,
+// windowing / FFT / binning happen on the shared analyser thread (see AnalyserThread)
+class FFTDataGenerator : public juce::TimeSliceClient
 {
 public:
     
@@ -55,37 +141,565 @@ public:
     
     static constexpr int fftOrder = 11; // 2^11 = 2048 samples
     static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int ringSize = fftSize * 4;
 
     FFTDataGenerator() : forwardFFT(fftOrder), window(fftSize, juce::dsp::WindowingFunction<float>::hann)
     {
         juce::zeromem(fftData, sizeof(fftData));
     }
 
-    // Feed in audio data here
-    void pushSamples(const juce::AudioBuffer<float>& buffer);
+    // AUDIO THREAD: feed in audio data here, drops samples while nobody is analysing (double blocks go in as float)
+    template <typename SampleType>
+    void pushSamples(const SampleType* samples, int numSamples);
+    
+    // MESSAGE THREAD, while the analyser thread isn't running this client: a new consumer starts from fresh audio,
+    // whatever was collected for the last one is thrown away
+    void attach();
+    void detach() { active.store(false); }
 
-    // Do FFT and return magnitude bins in dB
-    bool produceFFTData(std::vector<float>& outputBins);
+    // ANALYSER THREAD: drains the ring and runs the FFT whenever a frame is complete
+    int useTimeSlice() override;
+
+    // READER (message thread): newest complete frame, nullptr until the first one arrives
+    const AnalyserFrame* getLatestFrame();
 
 private:
-    float sampleRate = 44100.0f; // default fallback
+    // Do FFT and return magnitude bins in dB
+    bool produceFFTData(AnalyserFrame& frame);
+    void collectSamples(const float* samples, int numSamples);
+    
+    std::atomic<float> sampleRate { 44100.0f }; // default fallback
+    std::atomic<bool> active { false };
+
+    juce::AbstractFifo ringFifo { ringSize };
+    float ring[ringSize] = { 0 };
     
     float fifo[fftSize] = { 0 };
     float fftData[fftSize * 2] = { 0 };
     int fifoIndex = 0;
     bool nextFFTBlockReady = false;
+    
+    TripleBuffer<AnalyserFrame> frames;
+    bool hasFrame = false; // reader side only
 
     juce::dsp::FFT forwardFFT;
     juce::dsp::WindowingFunction<float> window;
 };
 
 
+// One analyser thread for every plugin instance in the process
+struct AnalyserThread : public juce::TimeSliceThread
+{
+    AnalyserThread() : juce::TimeSliceThread("LABEURRE analyser") { startThread(); }
+    ~AnalyserThread() override { stopThread(1000); }
+};
+
+
+
+
+//===================================================================================================================
+// DISTORTION OVERSAMPLING
+//
+// Every factor / filter combination is allocated in prepare(), switching is then just picking another
+// one on the audio thread. Filter mode 0 = polyphase IIR (low latency), 1 = equiripple FIR (linear phase).
+template <typename SampleType>
+class DistortionOversampler
+{
+public:
+    static constexpr int numFactors = 4; // 1x, 2x, 4x, 8x
+    
+    void prepare(size_t numChannels, int maxBlockSize);
+    void select(int factorIndex, int filterMode);
+    
+    // nullptr at 1x (or before prepare)
+    juce::dsp::Oversampling<SampleType>* getActive() const noexcept { return active; }
+    int getFactor() const noexcept { return active != nullptr ? (int) active->getOversamplingFactor() : 1; }
+    int getLatencySamples() const noexcept;
+    int getMaxLatencySamples() const noexcept; // of every prepared factor / filter
+    void reset(); // the active one
+    
+private:
+    // [filterMode][factorIndex - 1]
+    std::unique_ptr<juce::dsp::Oversampling<SampleType>> oversamplers[2][numFactors - 1];
+    juce::dsp::Oversampling<SampleType>* active = nullptr;
+};
+
+
+
+
+//===================================================================================================================
+// N-BAND CROSSOVER
+//
+// Linkwitz-Riley tree: split k peels band k off whatever is above the splits before it, so N bands cost N - 1
+// LR4 splits. The bands below split k never went through it, so each of them gets that split's LR4 allpass
+// (what LP + HP of an LR4 sums to) and every band ends up with the same phase, the sum stays flat.
+// State is kept per split / per band in flat arrays, the loops walk one band buffer at a time.
+template <typename SampleType>
+class CrossoverTree
+{
+public:
+    static constexpr int maxBands = 5;
+    static constexpr int maxSplits = maxBands - 1;
+    
+    void prepare(double newSampleRate, int newNumChannels);
+    void reset();
+    
+    // numBands - 1 ascending frequencies, changing the band count starts from silence
+    void setSplits(int newNumBands, const float* frequencies);
+    int getNumBands() const noexcept { return numBands; }
+    
+    // Splits one channel into numBands planar buffers, lowest band first. input may alias bandData[numBands - 1]
+    void process(int channel, const SampleType* input, SampleType* const* bandData, int numSamples) noexcept;
+    
+private:
+    void compensate(int split, int band, int channel, SampleType* data, int numSamples) noexcept;
+    
+    size_t splitIndex(int split, int channel) const noexcept { return (size_t) (split * numChannels + channel); }
+    size_t allpassIndex(int split, int band, int channel) const noexcept { return (size_t) ((split * maxBands + band) * numChannels + channel); }
+    
+    double sampleRate = 44100.0;
+    int numChannels = 0;
+    int numBands = 2;
+    
+    // per split, same TPT topology as juce::dsp::LinkwitzRileyFilter
+    float frequency[maxSplits] = {};
+    SampleType g[maxSplits] = {}, h[maxSplits] = {};
+    
+    // split filters (two cascaded SVFs), [split][channel]
+    std::vector<SampleType> s1, s2, s3, s4;
+    
+    // compensation allpasses (one SVF each), [split][band][channel]
+    std::vector<SampleType> ap1, ap2;
+};
+
+
+
+
+//===================================================================================================================
+// DOWNWARD COMPRESSION
+//
+// Drop-in for juce::dsp::Compressor (same peak detector, threshold / ratio maths and setters), except that
+// the gain is only recomputed every controlInterval samples and ramped linearly in between. The detector
+// still runs every sample. An interval of 1 is sample for sample the same as juce::dsp::Compressor.
+// With lookahead the detector sees the input right away and the gain lands on the input from that many samples ago,
+// the delay lines are sized for maxLookaheadMs in prepare.
+// Below identityRatio the detector stops and only the lookahead delay is left, switching in or out fades the gain
+// over fadeMs (coming back the detector starts from reset).
+template <typename SampleType>
+class DownwardCompressor
+{
+public:
+    static constexpr int controlIntervals[] = { 1, 8, 16, 32 };
+    static constexpr float maxLookaheadMs = 10.0f;
+    static constexpr float identityRatio = 1.001f; // moves the gain by less than 0.01 dB up to +10 dBFS
+    static constexpr float fadeMs = 5.0f;
+    
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+    
+    void setThreshold(float newThresholdDB);
+    void setRatio(float newRatio);
+    void setAttack(float newAttackMs);
+    void setRelease(float newReleaseMs);
+    void setControlInterval(int numSamples) { controlInterval = juce::jmax(1, numSamples); }
+    void setLookahead(int numSamples) { lookahead = juce::jlimit(0, delayMask, numSamples); }
+    
+    template <typename ProcessContext>
+    void process(const ProcessContext& context) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock = context.getOutputBlock();
+        
+        if (context.isBypassed)
+        {
+            outputBlock.copyFrom(inputBlock);
+            return;
+        }
+        
+        const auto numChannels = juce::jmin(outputBlock.getNumChannels(), channels.size());
+        const auto numSamples = (int) outputBlock.getNumSamples();
+        
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto* input = inputBlock.getChannelPointer(channel);
+            auto* output = outputBlock.getChannelPointer(channel);
+            
+            for (int i = 0; i < numSamples; ++i)
+                output[i] = processSample(channels[channel], input[i]);
+        }
+    }
+    
+    // In place on channel 0, the detector follows key instead (may be samples itself)
+    void processKeyed(SampleType* samples, const SampleType* key, int numSamples) noexcept;
+    
+    // Stereo linked, in place: left goes through this compressor, right through partner (same settings, channel 0 of
+    // each). Both detectors see their own key pulled towards the louder one by link, at 1 only this one runs.
+    // The keys are the signals themselves, or the matching sidechain bands.
+    void processLinked(DownwardCompressor& partner, SampleType* left, SampleType* right, const SampleType* keyLeft,
+                       const SampleType* keyRight, int numSamples, float link) noexcept;
+    
+private:
+    struct ChannelState
+    {
+        SampleType envelope = 0;
+        SampleType gain = 1, gainStep = 0;
+        int samplesUntilUpdate = 0;
+        
+        std::vector<SampleType> delayLine; // lookahead, delayMask + 1 samples
+        int writeIndex = 0;
+    };
+    
+    SampleType processSample(ChannelState& state, SampleType x) noexcept
+    {
+        const SampleType gain = nextGain(state, std::abs(x));
+        return delay(state, x) * gain;
+    }
+    
+    SampleType nextGain(ChannelState& state, SampleType level) noexcept;
+    SampleType delay(ChannelState& state, SampleType x) const noexcept;
+    SampleType computeGain(SampleType envelope) const noexcept;
+    void updateCoefficients();
+    void updateAmount();
+    
+    // identity stage: 0 and not fading, nothing but the delay runs
+    bool isSkipped() const noexcept { return amount == 0.0f && fadeRemaining == 0; }
+    bool isFading() const noexcept { return amount != 1.0f || fadeRemaining > 0; }
+    SampleType blend(SampleType gain) noexcept; // the gain through the in / out fade, one step per call
+    
+    std::vector<ChannelState> channels;
+    double sampleRate = 44100.0;
+    
+    float thresholdDB = 0.0f, ratio = 1.0f, attackMs = 1.0f, releaseMs = 100.0f;
+    SampleType thresholdInverse = 1, ratioInverse = 1;
+    SampleType attackCte = 0, releaseCte = 0;
+    int controlInterval = 1;
+    int lookahead = 0, delayMask = 0;
+    
+    // 1 = compressing, 0 = identity
+    float amount = 1.0f, amountTarget = 1.0f, amountStep = 0.0f;
+    int fadeSamples = 1, fadeRemaining = 0;
+};
+
+
+
+
+//===================================================================================================================
+// UPWARD COMPRESSION (OTT)
+//
+// The detector is a peak envelope with attack / release, run every sample. The gain is computed in dB
+// from that envelope only every controlInterval samples and ramped linearly in between, so it follows
+// the level instead of the waveform and the log / exp maths runs at control rate.
+
+// Envelope -> gain, shared by UpwardCompressor and the SIMD kernel lanes
+struct UpwardGainComputer
+{
+    float thresholdDB = -60.0f;
+    float slope = 0.0f;      // dB of lift per dB below the threshold, 1 - 1 / ratio
+    float maxBoostDB = 0.0f; // keeps silence from being pulled up without limit
+    
+    void set(const UpwardCompressorSettings& settings);
+    
+    // linear, in the precision of the envelope
+    template <typename SampleType>
+    SampleType getGain(SampleType envelope) const noexcept;
+};
+
+
+template <typename SampleType>
+class UpwardCompressor
+{
+public:
+    static constexpr float attackMs = 5.0f;
+    static constexpr float releaseMs = 120.0f;
+    
+    void prepare(double sampleRate);
+    void reset();
+    
+    void setSettings(const UpwardCompressorSettings& settings) { computer.set(settings); }
+    void setControlInterval(int numSamples) { controlInterval = juce::jmax(1, numSamples); }
+    
+    void process(SampleType* samples, int numSamples);
+    
+    // Stereo linked, in place, same rules as DownwardCompressor::processLinked
+    void processLinked(UpwardCompressor& partner, SampleType* left, SampleType* right, int numSamples, float link) noexcept;
+    
+private:
+    SampleType nextGain(SampleType level) noexcept;
+    
+    UpwardGainComputer computer;
+    SampleType attackCte = 0, releaseCte = 0;
+    SampleType envelope = 0;
+    SampleType gain = 1, gainStep = 0;
+    int controlInterval = 1;
+    int samplesUntilUpdate = 0;
+};
+
+
+
+
+//===================================================================================================================
+// SIMD MULTIBAND KERNEL
+//
+// Runs the whole stereo chain (crossover -> distortion -> upward comp -> downward comp -> makeup -> high cut)
+// with 2 channels x 2 bands packed into one SIMDRegister: lanes are { L low, L high, R low, R high }.
+// Every stage advances all four streams per instruction, the bands are only summed back at the very end
+// (the high cut is linear, so filtering each band before the sum is the same as filtering the sum).
+// With oversampling on, the lanes go planar for the distortion stage only, the rest stays at the host rate.
+// In mid/side mode the lanes are { M low, M high, S low, S high }, the matrix is part of packing / unpacking.
+// Downward lanes at an identity ratio fade out like DownwardCompressor, with all four out the detectors stop.
+// Float runs on one 4-lane register, double on two 2-lane ones (SIMDRegisterPair), the code is the same.
+
+// Four lanes out of two native registers of half the width, for double. Only the part of SIMDRegister's
+// interface the kernel uses, every operation goes to both halves
+template <typename SampleType>
+struct SIMDRegisterPair
+{
+    using Half = juce::dsp::SIMDRegister<SampleType>;
+    using ElementType = SampleType;
+    static constexpr size_t halfSize = Half::SIMDNumElements;
+    static constexpr size_t SIMDNumElements = 2 * halfSize;
+    static constexpr size_t SIMDRegisterSize = Half::SIMDRegisterSize; // alignment of the raw arrays
+    
+    Half low, high; // lanes [0, halfSize), [halfSize, SIMDNumElements)
+    
+    static SIMDRegisterPair expand(SampleType s) noexcept { return { Half::expand(s), Half::expand(s) }; }
+    static SIMDRegisterPair fromRawArray(const SampleType* a) noexcept { return { Half::fromRawArray(a), Half::fromRawArray(a + halfSize) }; }
+    void copyToRawArray(SampleType* a) const noexcept { low.copyToRawArray(a); high.copyToRawArray(a + halfSize); }
+    
+    SampleType get(size_t i) const noexcept { return i < halfSize ? low.get(i) : high.get(i - halfSize); }
+    void set(size_t i, SampleType s) noexcept { if (i < halfSize) low.set(i, s); else high.set(i - halfSize, s); }
+    
+    static SIMDRegisterPair abs(SIMDRegisterPair x) noexcept { return { Half::abs(x.low), Half::abs(x.high) }; }
+    static SIMDRegisterPair min(SIMDRegisterPair a, SIMDRegisterPair b) noexcept { return { Half::min(a.low, b.low), Half::min(a.high, b.high) }; }
+    static SIMDRegisterPair max(SIMDRegisterPair a, SIMDRegisterPair b) noexcept { return { Half::max(a.low, b.low), Half::max(a.high, b.high) }; }
+    
+    SIMDRegisterPair operator+(SIMDRegisterPair o) const noexcept { return { low + o.low, high + o.high }; }
+    SIMDRegisterPair operator-(SIMDRegisterPair o) const noexcept { return { low - o.low, high - o.high }; }
+    SIMDRegisterPair operator*(SIMDRegisterPair o) const noexcept { return { low * o.low, high * o.high }; }
+    SIMDRegisterPair operator*(SampleType s) const noexcept { return { low * s, high * s }; }
+    
+    SIMDRegisterPair& operator+=(SIMDRegisterPair o) noexcept { low += o.low; high += o.high; return *this; }
+    SIMDRegisterPair& operator*=(SIMDRegisterPair o) noexcept { low *= o.low; high *= o.high; return *this; }
+    
+    static_assert(SIMDNumElements == 4, "two registers of two lanes");
+};
+
+
+template <typename SampleType>
+class SIMDMultiBandKernel
+{
+public:
+    static constexpr size_t numLanes = 4;
+    using Vec = std::conditional_t<juce::dsp::SIMDRegister<SampleType>::SIMDNumElements == numLanes,
+                                   juce::dsp::SIMDRegister<SampleType>, SIMDRegisterPair<SampleType>>;
+
+    void prepare(double newSampleRate, int maxBlockSize);
+    void reset();
+
+    // the per band settings take one entry per lane, in lane order
+    void setCrossoverFrequency(float frequency);
+    void setMidSide(bool enabled);
+    void setDistortion(int type, const distortionSettings* laneSettings);
+    void setCompressorMode(int mode) { compMode = juce::jlimit(0, 2, mode); } // 2 = OTT, adds the upward stage
+    void setUpwardCompression(const UpwardCompressorSettings* laneSettings);
+    void setControlInterval(int numSamples) { controlInterval = juce::jmax(1, numSamples); } // both compressors
+    void setCompressor(const CompressorSettings* laneSettings, float attackMs, float releaseMs);
+    void setStereoLink(float amount) { linkAmount = juce::jlimit(0.0f, 1.0f, amount); stereoLink = Vec::expand(linkAmount); } // both compressors
+    void setLookahead(int numSamples) { lookahead = juce::jlimit(0, lookaheadMask, numSamples); }   // downward only
+    void setHighCut(const juce::dsp::IIR::Coefficients<SampleType>& coefficients);
+    void setOversampling(int factorIndex, int filterMode);
+    void setAntiAliasing(bool enabled) { adaaStale = adaaStale || ! enabled; adaaEnabled = enabled; } // x1 stops following while off
+    
+    int getLatencySamples() const noexcept { return oversampler.getLatencySamples(); }
+
+    // Processes a stereo pair in place, picks the specialised kernel once per call.
+    // With a key pair (sidechain) the downward detectors follow its bands, split the same way as the signal.
+    void process(SampleType* left, SampleType* right, int numSamples,
+                 const SampleType* keyLeft = nullptr, const SampleType* keyRight = nullptr);
+
+private:
+    static Vec lanes(SampleType lowL, SampleType highL, SampleType lowR, SampleType highR);
+    static Vec bands(SampleType low, SampleType high) { return lanes(low, high, low, high); }
+    
+    static Vec gather(SampleType* const* channels, int index);
+    static void scatter(Vec x, SampleType* const* channels, int index);
+    
+    // one stereo frame in / out of the lanes, mid/side encoding and decoding included
+    Vec pack(SampleType left, SampleType right) const noexcept { return encodeLeft * left + encodeRight * right; }
+    void unpack(Vec x, SampleType& left, SampleType& right) const noexcept;
+
+    // the crossover's filter state, one for the signal and one for the key
+    struct SplitState
+    {
+        Vec s1, s2, s3, s4;
+    };
+    
+    // stages, the mode dependent ones are specialised at compile time so the per sample loops never branch on them
+    Vec split(Vec x, SplitState& state);
+    template <int DistType, bool ADAA> Vec distort(Vec x);
+    Vec shapeWarm(Vec x, Vec drive);
+    Vec shapeCore(Vec x, Vec drive);
+    static Vec tanh(Vec x); // fastTanh, on the whole register where it has a vector version
+    template <int CompMode, bool Keyed, bool Linked> Vec dynamics(Vec x, Vec key);
+    Vec linkLevels(Vec level) const noexcept;
+    Vec highCut(Vec x);
+    
+    // compressor mode past the three speeds: no upward stage and every lane's downward one is an identity,
+    // only the lookahead delay and the makeup are left
+    static constexpr int dynamicsOff = 3;
+    
+    // one instantiation per distortion type x compressor mode (x ADAA on / off), processAs picks keyed / linked or not
+    // once per block, so an unlinked pair never pays for the lane swap
+    template <int DistType, int CompMode, bool ADAA>
+    void processAs(SampleType* left, SampleType* right, const SampleType* keyLeft, const SampleType* keyRight, int numSamples);
+    
+    template <int DistType, int CompMode, bool ADAA, bool Keyed, bool Linked>
+    void processWith(SampleType* left, SampleType* right, const SampleType* keyLeft, const SampleType* keyRight, int numSamples);
+    
+    template <int DistType, int CompMode, bool ADAA, bool Keyed, bool Linked>
+    void processFused(SampleType* left, SampleType* right, const SampleType* keyLeft, const SampleType* keyRight, int numSamples);
+    
+    template <int DistType, int CompMode, bool ADAA, bool Keyed, bool Linked>
+    void processOversampled(juce::dsp::Oversampling<SampleType>& os, SampleType* left, SampleType* right,
+                            const SampleType* keyLeft, const SampleType* keyRight, int numSamples);
+
+    double sampleRate = 44100.0;
+    float crossoverFreq = -1.0f;
+
+    // Linkwitz-Riley (TPT) crossover, every lane splits its own channel and keeps one band
+    Vec g, h;
+    SplitState signalSplit, keySplit;
+    Vec keepLow, keepHigh;
+    
+    // stereo: encode is { 1, 1, 0, 0 } / { 0, 0, 1, 1 } and decode the plain band sums,
+    // mid/side: M = (L + R) / 2, S = (L - R) / 2 into the lanes, L = M + S, R = M - S out of them
+    Vec encodeLeft, encodeRight;
+    float sideToLeft = 0.0f, midToRight = 0.0f, sideToRight = 1.0f;
+
+    // distortion
+    int distType = 0;
+    float distAlpha = DistortionState<SampleType>::envelopeAlpha; // envelope smoothing, scaled down with the oversampling factor
+    Vec drive, crushScale, dontGain, distEnvelope;
+    juce::SharedResourcePointer<WaveshaperTables> tables;
+    
+    // ADAA shaping, previous input of every stage per lane (the envelope above is shared with the plain curves)
+    bool adaaEnabled = false;
+    bool adaaStale = true; // the next ADAA sample primes adaaX1 from its own stage inputs
+    SampleType adaaX1[numLanes][3] = {};
+    
+    // oversampled distortion, one planar channel per lane
+    DistortionOversampler<SampleType> oversampler;
+    juce::AudioBuffer<SampleType> laneBuffer;
+
+    // both compressors recompute their gain every controlInterval samples and ramp in between
+    int controlInterval = 1;
+    int samplesUntilUpdate = 0;
+    
+    // detector levels of the two channels pulled together, per band
+    Vec stereoLink;
+    float linkAmount = 0.0f;
+
+    // upward compression (OTT)
+    int compMode = 0;
+    UpwardGainComputer upComputers[numLanes];
+    Vec upAttackCte, upReleaseCte, upEnvelope, upGain, upGainStep;
+
+    // downward compression + makeup
+    Vec compThresholdInv, compExponent, compEnvelope, compGain, compGainStep, makeupGain;
+    Vec attackCte, releaseCte;
+    
+    // per lane 1 = compressing, 0 = identity (below DownwardCompressor::identityRatio), faded like the band engine's
+    Vec compAmount, compAmountTarget, compAmountStep;
+    int fadeSamples = 1, fadeRemaining = 0;
+    bool compBlend = false;   // a lane isn't all the way on, the gain goes through compAmount
+    bool compIdentity = false; // every lane's target is 0
+    
+    // lookahead delay in front of the downward gain, sized for DownwardCompressor::maxLookaheadMs
+    std::vector<Vec> lookaheadLine;
+    int lookahead = 0, lookaheadMask = 0, lookaheadWrite = 0;
+
+    // high cut biquad (transposed direct form II)
+    Vec b0, b1, b2, a1, a2, z1, z2;
+
+    static_assert(Vec::SIMDNumElements == numLanes, "a kernel frame is four lanes");
+};
+
+
+
+
+//===================================================================================================================
+// DRY / WET
+//
+// The input goes into the dry delay line as the block comes in, the processed block is then mixed with it in place,
+// reading the dry latency samples back so both line up. The wet proportion is smoothed per sample inside that pass.
+// Linear crossfade: dry and wet are time aligned, so they add up like the same signal, not like two unrelated ones.
+//
+// Bypass reads the same line, further back by whatever comes after the mix (the ceiling), and fades the finished
+// output over to it. Once it's all the way over the chain doesn't have to run at all.
+template <typename SampleType>
+class DryWetMix
+{
+public:
+    static constexpr float smoothingSeconds = 0.05f;
+    
+    // MESSAGE THREAD, maxLatency is the most setLatency + the bypass' extra latency will ever be asked for
+    void prepare(double sampleRate, int numChannels, int maxBlockSize, int maxLatency);
+    
+    // AUDIO THREAD
+    void reset();
+    void setMix(float wetProportion) { wet.setTargetValue(juce::jlimit(0.0f, 1.0f, wetProportion)); }
+    void setLatency(int numSamples) { latency = juce::jlimit(0, maxLatencySamples, numSamples); }
+    void setBypassed(bool shouldBeBypassed) { processed.setTargetValue(shouldBeBypassed ? 0.0f : 1.0f); }
+    bool isBypassed() const noexcept { return ! processed.isSmoothing() && processed.getTargetValue() == 0.0f; } // faded all the way
+    void skip(int numSamples) noexcept { wet.skip(numSamples); processed.skip(numSamples); } // blocks that don't mix
+    
+    void pushDry(const SampleType* const* channelData, int numChannels, int numSamples) noexcept; // before processing
+    void mixWet(SampleType* const* channelData, int numChannels, int numSamples) noexcept;         // after, same block
+    void fadeBypass(SampleType* const* channelData, int numChannels, int numSamples, int extraLatency) noexcept; // last
+    
+private:
+    juce::SmoothedValue<float> wet { 1.0f };
+    juce::SmoothedValue<float> processed { 1.0f }; // 0 = bypassed
+    
+    // [channel][size], power of two, holds the latency plus one block
+    std::vector<SampleType> lines;
+    int numChannels = 0, size = 0, writePosition = 0;
+    int latency = 0, maxLatencySamples = 0;
+};
+
+
+//===================================================================================================================
+// SIDECHAIN KEY DELAY
+//
+// The signal reaches the detectors after the oversampling filters (and ADAA's half samples), the key doesn't go
+// through either. Delayed here by the same integer latency, in place, before anything splits it.
+template <typename SampleType>
+class KeyDelay
+{
+public:
+    // MESSAGE THREAD
+    void prepare(int numChannels, int maxDelay);
+    
+    // AUDIO THREAD
+    void reset();
+    void setDelay(int numSamples) { delay = juce::jlimit(0, size - 1, numSamples); }
+    void process(SampleType* const* channelData, int numChannels, int numSamples) noexcept;
+    
+private:
+    // [channel][size], power of two
+    std::vector<SampleType> lines;
+    int maxChannels = 0, size = 1, writePosition = 0, delay = 0;
+    int lastNumChannels = 0; // a key that comes back starts from silence, not from where it stopped
+};
+
+
 
 
 //===================================================================================================================
 /**
 */
-class SimpleEQAudioProcessor  : public juce::AudioProcessor
+class SimpleEQAudioProcessor  : public juce::AudioProcessor, private juce::AudioProcessorValueTreeState::Listener,
+                                private juce::Timer
 {
 public:
     //==============================================================================
@@ -101,6 +715,12 @@ public:
 #endif
     
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    
+    // double precision runs its own copy of the chain (see Engine), the host picks one before prepareToPlay
+    bool supportsDoublePrecisionProcessing() const override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
     
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -129,11 +749,14 @@ public:
     
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Parameters", createParameterLayout()};
+    ParameterPointers parameters;
     
     
     FFTDataGenerator fftData;
-    std::vector<float> fftBins;
-    const std::vector<float>& getFftData() const { return fftBins; } // Getter for the editor
+    const AnalyserFrame* getFftData() { return fftData.getLatestFrame(); } // Getter for the editor
+    
+    // the editor switches the analyser on while it's open
+    void setAnalyserActive(bool shouldBeActive);
 
     
     
@@ -144,29 +767,170 @@ private:
 
     // Define filters and compressors
     using Filter = juce::dsp::IIR::Filter<float>;
-    using Compressor = juce::dsp::Compressor<float>;
-    using Gain = juce::dsp::Gain<float>;
 
-    // Crossover filter (Linkwitz-Riley)
-    using Crossover = juce::dsp::LinkwitzRileyFilter<float>;
-
-    juce::dsp::IIR::Filter<float> lowPassFilter;
-    // Low-band chain: Low-pass + Compressor
-    using LowBandChain = juce::dsp::ProcessorChain<Filter, Compressor, Gain>;
-
-    // High-band chain: High-pass + Compressor
-    using HighBandChain = juce::dsp::ProcessorChain<Filter, Compressor, Gain>;
-
-    // Full Processor Chain: Crossover, then two independent bands
-    using MultiBandCompressorChain = juce::dsp::ProcessorChain<
-        Crossover, // Band-splitter
-        LowBandChain,
-        HighBandChain,
-        Filter
-    >;
-
-   
-    MultiBandCompressorChain leftChain, rightChain;
+    static constexpr int maxBands = CrossoverTree<float>::maxBands;
+    
+    // linear phase alternative to the tree, kernels are rebuilt on the shared builder thread
+    LinearPhaseCrossover linearCrossover;
+    bool linearPhase = false;
+    juce::SharedResourcePointer<KernelBuilderThread> kernelBuilderThread;
+    
+    static_assert(LinearPhaseCrossover::maxBands == maxBands, "both crossovers feed the same band engine");
+    
+    // everything the band engine keeps for one channel
+    template <typename SampleType>
+    struct ChannelChain
+    {
+        DownwardCompressor<SampleType> compressors[maxBands];
+        UpwardCompressor<SampleType> upwardCompressors[maxBands]; // OTT stage
+        DistortionState<SampleType> distortionStates[maxBands];
+        DistortionOversampler<SampleType> oversampler;            // all bands of the channel go through it together
+        juce::dsp::IIR::Filter<SampleType> highCut;
+        
+        // per band settings, derived once in the update functions (the side channel has its own)
+        distortionSettings distortion[maxBands];
+        SampleType makeupGains[maxBands] = { 1, 1, 1, 1, 1 };
+    };
+    
+    // Everything that holds audio, once per sample type. prepareToPlay only fills the one for the host's
+    // precision and releases the other, so a float session never carries the double chain around
+    template <typename SampleType>
+    struct Engine
+    {
+        // N-band engine: crossover tree, then every band runs distortion -> upward comp -> downward comp -> makeup,
+        // summed and high cut per channel
+        CrossoverTree<SampleType> crossover;
+        
+        // one per channel of the bus layout, resized in prepareToPlay (never on the audio thread), in one allocation
+        std::vector<ChannelChain<SampleType>> channelChains;
+        
+        // with two minimum phase bands, every group of two goes through a SIMD kernel (kernel n is group n),
+        // a group of one and every other setup through the band engine above
+        juce::OwnedArray<SIMDMultiBandKernel<SampleType>> stereoKernels;
+        
+        // Band buffer for the block pipeline (one channel per band, lowest first), sized once in prepareToPlay
+        juce::AudioBuffer<SampleType> bandBuffer;
+        
+        // bands of every sidechain channel, laid out like bandBuffer ([channel * maxBands + band])
+        juce::AudioBuffer<SampleType> sidechainBands;
+        
+        // lines the key up with the oversampled signal, set in updateLatency
+        KeyDelay<SampleType> keyDelay;
+        
+        // dry path for the mix, delayed by the chain's latency (everything in front of the ceiling)
+        DryWetMix<SampleType> dryWet;
+        
+        // output ceiling after the mix, every channel, adds its latency only while it's on
+        TruePeakLimiter<SampleType> truePeakLimiter;
+        
+        void release() { *this = Engine(); }
+    };
+    
+    Engine<float> floatEngine;
+    Engine<double> doubleEngine;
+    
+    template <typename SampleType>
+    Engine<SampleType>& getEngine() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleEngine;
+        else
+            return floatEngine;
+    }
+    
+    template <typename SampleType> void prepare(double sampleRate, int samplesPerBlock, int numChannels);
+    
+    // channels 0 / 1 as mid / side, encoded in front of the crossover and decoded after the high cut
+    bool midSide = false;
+    
+    // channels that run side by side: the pairs of the layout (L/R, Ls/Rs, ...) can have their detectors linked,
+    // the channels without a partner (C, LFE, ambisonics) are paired up unlinked, an odd one out runs alone.
+    // Built in prepareToPlay, the linkable pairs first: on every layout isBusesLayoutSupported accepts, group 0 is
+    // channels 0 / 1 when there are two, the only pair mid/side touches
+    struct ChannelGroup
+    {
+        int channels[2];
+        int numChannels;
+        bool linkable;
+    };
+    
+    std::vector<ChannelGroup> channelGroups;
+    static std::vector<ChannelGroup> getChannelGroups(const juce::AudioChannelSet& layout, int numChannels);
+    
+    // the ceiling adds its latency only while it's on
+    bool ceilingActive = false;
+    
+    // BYPASS / IDLE -----------------------------
+    
+    // below this on every channel, in and out, counts as silence
+    static constexpr float silenceThresholdDB = -110.0f;
+    
+    // crossover ringing left after the latency, the IIR filters are well below the threshold by then
+    static constexpr double ringingSeconds = 0.05;
+    
+    // five time constants of the slowest release, the detectors have let go by then
+    static constexpr double settleSeconds = 1.0;
+    
+    std::atomic<double> tailSeconds { 0.0 }; // set in updateLatency, read by the host from any thread
+    int tailSamples = 0;
+    
+    // updateLatency runs on the audio thread and only stores it, timerCallback polls it on the message thread
+    // and tells the host (posting a message from the audio thread could block or allocate)
+    std::atomic<int> reportedLatency { 0 };
+    static constexpr int latencyPollHz = 10;
+    void timerCallback() override;
+    
+    // idle: silent in and out for tail + settle, the chain is skipped until a block has signal in it again
+    int silentSamples = 0;
+    bool idle = false;
+    
+    // back from a full bypass the chain starts clean and runs unheard for a tail before fading in
+    bool chainStale = false;
+    int primingSamples = 0;
+    
+    juce::SharedResourcePointer<AnalyserThread> analyserThread;
+    juce::SharedResourcePointer<WaveshaperTables> waveshaperTables; // plain (non ADAA) distortion curves
+    
+    // DIRTY TRACKING -----------------------------
+    
+    // set from parameterChanged (any thread), consumed once per block on the audio thread
+    enum DirtyFlags : juce::uint32
+    {
+        compressorDirty = 1 << 0,
+        filterDirty     = 1 << 1,
+        crossoverDirty  = 1 << 2,
+        distortionDirty = 1 << 3,
+        oversamplingDirty = 1 << 4,
+        limiterDirty    = 1 << 5,
+        latencyDirty    = 1 << 6,
+        allDirty        = compressorDirty | filterDirty | crossoverDirty | distortionDirty | oversamplingDirty | limiterDirty | latencyDirty
+    };
+    
+    std::atomic<juce::uint32> dirtyFlags { allDirty };
+    
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    
+    // EXTERNAL SIDECHAIN -----------------------------
+    
+    // the crossovers keep split state for these past the main channels, the sidechain goes through the same splits
+    static constexpr int maxSidechainChannels = 2;
+    
+    int getNumSidechainChannels(const ChainSettings& settings) const;
+    template <typename SampleType>
+    void splitSidechain(SampleType* const* sidechainData, int numSidechainChannels, int numSamples);
+    
+    template <typename SampleType> void process(juce::AudioBuffer<SampleType>& buffer, bool bypassed);
+    
+    // at most bandBuffer's length, process hands bigger host blocks over in pieces
+    template <typename SampleType>
+    void processChunk(juce::AudioBuffer<SampleType>& buffer, const ChainSettings& settings, bool bypassed);
+    template <typename SampleType>
+    void processChannelGroup(SampleType* const* channelData, const ChannelGroup& group, int numSamples,
+                             int numSidechainChannels, const ChainSettings& settings);
+    template <int CompMode, typename SampleType>
+    void compressBands(const ChannelGroup& group, int numSamples, int numSidechainChannels, float stereoLink);
+    template <typename SampleType> void resetBands();
+    template <typename SampleType> void resetChain(); // every stage that holds audio, not just the bands
     
   
     //void updatePeakFilter(const ChainSettings& chainSettings);
@@ -180,25 +944,44 @@ private:
     // COMPRESSOR METHODS -----------------------------
     
     CompressorSettings getCompressorSettings(const double intensity);
-    int getCompressorSpeedMode();
+    std::pair<float, float> getCompressorTimes(int compressorSpeed);
     UpwardCompressorSettings getUpwardCompSettings(const double intensity);
     
-    void applyCompressorSettings(juce::dsp::Compressor<float>& compressor, juce::dsp::Gain<float>& gain, const CompressorSettings& settings, int compressorSpeed);
-    
+    template <typename SampleType>
+    void applyCompressorSettings(DownwardCompressor<SampleType>& compressor, const CompressorSettings& settings,
+                                 int compressorSpeed, int controlInterval);
     
-    void updateCompressor();
     
-    void applyUpwardCompression(float& lowSample, float& highSample, float compLowIntensity, float compHighIntensity);
-    std::pair<float, float> applyUpwardCompression(float low, float high);
+    // the engine for the sample type the block comes in
+    template <typename SampleType> void updateCompressor(const ChainSettings& chainSettings);
     
-    void updateFilter();
+    template <typename SampleType> void updateFilter(const ChainSettings& chainSettings);
+    template <typename SampleType> void updateCrossover(const ChainSettings& chainSettings);
+    template <typename SampleType> void updateDistortion(const ChainSettings& chainSettings);
+    template <typename SampleType> void updateOversampling(const ChainSettings& chainSettings);
+    template <typename SampleType> void updateLimiter(const ChainSettings& chainSettings);
+    template <typename SampleType> void updateLatency(const ChainSettings& chainSettings);
+    int getLookaheadSamples(const ChainSettings& chainSettings) const;
+    int getAntiAliasingLatency(const ChainSettings& chainSettings) const;
+    static constexpr int maxAntiAliasingLatency = 2; // DON'T's 1.5 samples at 1x, rounded up
     // DISTORTION METHODS -----------------------------
     
-    float distortionSample(float x, float y_old, float drive, float c);
+    template <int DistType, typename SampleType>
+    SampleType distortionSample(SampleType x, DistortionState<SampleType>& state, float drive, float c, float alpha);
+    // WARM at drive 1 is h(x) = tanh(x) + 0.15 tanh^3(x) ~ x - 0.18 x^3, under this peak within -60 dB of x
+    static constexpr float warmIdentityPeak = 0.07f;
+    
+    template <int DistType, typename SampleType>
+    void distortBands(juce::dsp::AudioBlock<SampleType>& bands, DistortionState<SampleType>* bandStates,
+                      const distortionSettings* bandSettings, bool adaa, float envelopeAlpha);
+    
+    template <typename SampleType> SampleType distortionWarm(SampleType x, float drive, float c);
+    template <typename SampleType> SampleType distortionCrush(SampleType x, DistortionState<SampleType>& state, float drive, float c, float alpha);
+    template <typename SampleType> SampleType distortionDONT(SampleType x, DistortionState<SampleType>& state, float drive, float c, float alpha);
     
-    float distortionWarm(float x, float y_old, float drive, float c);
-    float distortionCrush(float x, float y_old, float drive, float c);
-    float distortionDONT(float x, float y_old, float drive, float c);
+    // same curves, band limited through their antiderivatives
+    template <int DistType, typename SampleType>
+    SampleType distortionSampleADAA(SampleType x, DistortionState<SampleType>& state, float drive, float alpha, bool prime = false);
    
     float asymmetricSoftClip(float x, float posThreshold = 1.0f, float negThreshold = -0.8f);
     
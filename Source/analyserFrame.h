@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    analyserFrame.h
+    Created: 17 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// One complete spectrum frame, magnitude in dB per display band
+struct AnalyserFrame
+{
+    static constexpr int numBins = 24;
+
+    std::array<float, numBins> bins {};
+};
+
+
+//==============================================================================
+// Lock-free triple buffer for exactly one writer thread and one reader thread.
+// The writer always has a private slot to fill, the reader always has a private slot
+// to look at, and the third slot is swapped between them, so nothing is ever copied,
+// allocated or torn.
+template <typename T>
+class TripleBuffer
+{
+public:
+    // WRITER: fill this, then publish()
+    T& getWriteBuffer() noexcept { return buffers[(size_t) writeIndex]; }
+
+    void publish() noexcept
+    {
+        writeIndex = middle.exchange(writeIndex | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // READER: picks up the newest published slot, returns false if nothing new arrived
+    bool acquire() noexcept
+    {
+        if ((middle.load(std::memory_order_relaxed) & freshBit) == 0)
+            return false;
+
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const T& getReadBuffer() const noexcept { return buffers[(size_t) readIndex]; }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshBit  = 4;
+
+    std::array<T, 3> buffers {};
+    int writeIndex = 0;
+    int readIndex  = 1;
+    std::atomic<int> middle { 2 };
+};
@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    fastTanh.h
+    Created: 17 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Set to 1 (e.g. in the Projucer preprocessor definitions) to render with the exact std::tanh
+#ifndef LABEURRE_EXACT_TANH
+ #define LABEURRE_EXACT_TANH 0
+#endif
+
+//==============================================================================
+// tanh as a [13/6] rational on x clamped to +-7.9053 (beyond that tanh rounds to +-1 in float).
+// Max abs error against std::tanh over the whole float line: 4.0e-7, measured in 1e-5 steps on [-60, 60].
+// Odd, monotonic and bounded by 1, so the curves keep their shape and never overshoot.
+// No exp, no branches: the vector version is plain mul/add apart from the one divide.
+namespace fastTanh
+{
+    namespace detail
+    {
+        constexpr float clampLimit = 7.90531110763549805f;
+
+        constexpr float alpha1  =  4.89352455891786e-03f;
+        constexpr float alpha3  =  6.37261928875436e-04f;
+        constexpr float alpha5  =  1.48572235717979e-05f;
+        constexpr float alpha7  =  5.12229709037114e-08f;
+        constexpr float alpha9  = -8.60467152213735e-11f;
+        constexpr float alpha11 =  2.00018790482477e-13f;
+        constexpr float alpha13 = -2.76076847742355e-16f;
+
+        constexpr float beta0 = 4.89352518554385e-03f;
+        constexpr float beta2 = 2.26843463243900e-03f;
+        constexpr float beta4 = 1.18534705686654e-04f;
+        constexpr float beta6 = 1.19825839466702e-06f;
+
+        template <typename T>
+        inline void rational(T x, T& numerator, T& denominator)
+        {
+            const T x2 = x * x;
+
+            T p = x2 * alpha13 + alpha11;
+            p = p * x2 + alpha9;
+            p = p * x2 + alpha7;
+            p = p * x2 + alpha5;
+            p = p * x2 + alpha3;
+            p = p * x2 + alpha1;
+            numerator = p * x;
+
+            T q = x2 * beta6 + beta4;
+            q = q * x2 + beta2;
+            denominator = q * x2 + beta0;
+        }
+    }
+
+    inline float tanh(float x) noexcept
+    {
+       #if LABEURRE_EXACT_TANH
+        return std::tanh(x);
+       #else
+        x = juce::jlimit(-detail::clampLimit, detail::clampLimit, x);
+
+        float p, q;
+        detail::rational(x, p, q);
+        return p / q;
+       #endif
+    }
+
+    // all four lanes at once, SIMDRegister has no divide so that one step goes per lane
+    inline juce::dsp::SIMDRegister<float> tanh(juce::dsp::SIMDRegister<float> x) noexcept
+    {
+        using Vec = juce::dsp::SIMDRegister<float>;
+
+       #if LABEURRE_EXACT_TANH
+        for (size_t i = 0; i < Vec::SIMDNumElements; ++i)
+            x.set(i, std::tanh(x.get(i)));
+
+        return x;
+       #else
+        x = Vec::min(Vec::max(x, Vec::expand(-detail::clampLimit)), Vec::expand(detail::clampLimit));
+
+        Vec p, q;
+        detail::rational(x, p, q);
+
+        for (size_t i = 0; i < Vec::SIMDNumElements; ++i)
+            p.set(i, p.get(i) / q.get(i));
+
+        return p;
+       #endif
+    }
+}
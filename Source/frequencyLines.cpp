@@ -34,7 +34,9 @@ void frequencyLines::paint (juce::Graphics& g)
     constexpr int kSkipHigh = 1;   // 1 highest-freq bin skipped
     constexpr int kLines    = 20;  // lines to actually draw
 
-    if ((int) smoothedBins.size() < kSkipLow + kSkipHigh + kLines)
+    static_assert(AnalyserFrame::numBins >= kSkipLow + kSkipHigh + kLines, "not enough analyser bins");
+
+    if (! hasData)
         return;
 
     const float bassDownScaleIntensity = 1.0f;       // 0 = off, 1 = full slope
@@ -76,17 +78,18 @@ void frequencyLines::paint (juce::Graphics& g)
 void frequencyLines::resized() {}
 
 //==============================================================================
-void frequencyLines::setFFTData (const std::vector<float>& newFFTData)
+void frequencyLines::setFFTData (const AnalyserFrame& newFrame)
 {
     constexpr float smoothing = 0.9f;
 
-    if (smoothedBins.size() != newFFTData.size())
-        smoothedBins = newFFTData; // initialise on first call or size change
-
-    for (size_t i = 0; i < newFFTData.size(); ++i)
-        smoothedBins[i] = smoothing * smoothedBins[i] + (1.0f - smoothing) * newFFTData[i];
+    if (! hasData)
+    {
+        smoothedBins = newFrame.bins; // initialise on first frame
+        hasData = true;
+    }
 
-    fftBins = newFFTData; // keep raw copy if needed elsewhere
+    for (size_t i = 0; i < smoothedBins.size(); ++i)
+        smoothedBins[i] = smoothing * smoothedBins[i] + (1.0f - smoothing) * newFrame.bins[i];
 }
 
 //==============================================================================
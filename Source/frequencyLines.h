@@ -11,6 +11,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "analyserFrame.h"
 
 //==============================================================================
 /*
@@ -25,14 +26,14 @@ public:
     void paint(juce::Graphics&) override;
     void resized() override;
 
-    void setFFTData(const std::vector<float>& newFFTData);
+    void setFFTData(const AnalyserFrame& newFrame);
 
 private:
     
     void timerCallback() override;
 
-    std::vector<float> fftBins;
-    std::vector<float> smoothedBins;
+    std::array<float, AnalyserFrame::numBins> smoothedBins {};
+    bool hasData = false;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(frequencyLines)
 };
@@ -0,0 +1,328 @@
+/*
+  ==============================================================================
+
+    linearPhaseCrossover.cpp
+    Created: 17 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "linearPhaseCrossover.h"
+
+void LinearPhaseCrossover::prepare(double newSampleRate, int newNumChannels)
+{
+    sampleRate = newSampleRate;
+    numChannels = juce::jmax(0, newNumChannels);
+    channels.resize((size_t) numChannels);
+
+    for (auto& set : kernelSets)
+    {
+        set.numBands = 0;
+        set.spectra.assign((size_t) (maxBands * numPartitions * spectrumSize), 0.0f);
+    }
+
+    for (auto& state : channels)
+    {
+        state.input.assign((size_t) fftSize, 0.0f);
+        state.history.assign((size_t) (numPartitions * spectrumSize), 0.0f);
+        state.output.assign((size_t) (maxBands * partitionSize), 0.0f);
+    }
+
+    // the real only transforms want room for 2 * fftSize floats
+    fftBuffer.assign((size_t) (2 * fftSize), 0.0f);
+    builderBuffer.assign((size_t) (2 * fftSize), 0.0f);
+    accumulator.assign((size_t) spectrumSize, 0.0f);
+    fadeBuffer.assign((size_t) partitionSize, 0.0f);
+
+    window.resize((size_t) kernelLength);
+    juce::dsp::WindowingFunction<double>::fillWindowingTables(window.data(), (size_t) kernelLength,
+                                                              juce::dsp::WindowingFunction<double>::kaiser, false, 10.0);
+    lowPass.resize((size_t) kernelLength);
+    previousLowPass.resize((size_t) kernelLength);
+
+    activeSet = 0;
+    fadeTarget = -1;
+    builderState = 0;
+    builtCount = requestCount.load();
+    lastBands = 0;
+
+    reset();
+}
+
+
+void LinearPhaseCrossover::buildPendingKernels()
+{
+    useTimeSlice();
+    reset();
+}
+
+
+void LinearPhaseCrossover::reset()
+{
+    for (auto& state : channels)
+    {
+        std::fill(state.input.begin(), state.input.end(), 0.0f);
+        std::fill(state.history.begin(), state.history.end(), 0.0f);
+        std::fill(state.output.begin(), state.output.end(), 0.0f);
+        state.head = 0;
+        state.position = 0;
+        state.fadePending = false;
+    }
+
+    // nothing left to fade from, a finished build is taken over as it is
+    if (fadeTarget >= 0)
+    {
+        activeSet = fadeTarget;
+        fadeTarget = -1;
+        builderState.store(0, std::memory_order_release);
+    }
+    else if (builderState.load(std::memory_order_acquire) == 2)
+    {
+        activeSet = 1 - activeSet;
+        builderState.store(0, std::memory_order_release);
+    }
+}
+
+
+void LinearPhaseCrossover::setSplits(int numBands, const float* frequencies)
+{
+    numBands = juce::jlimit(2, maxBands, numBands);
+
+    if (numBands == lastBands && std::equal(frequencies, frequencies + numBands - 1, lastFrequencies))
+        return;
+
+    lastBands = numBands;
+    std::copy(frequencies, frequencies + numBands - 1, lastFrequencies);
+
+    for (int split = 0; split < numBands - 1; ++split)
+        requestedFrequencies[split].store(frequencies[split], std::memory_order_relaxed);
+
+    requestedBands.store(numBands, std::memory_order_relaxed);
+    requestCount.fetch_add(1, std::memory_order_release);
+}
+
+
+void LinearPhaseCrossover::beginBlock(int numActiveChannels)
+{
+    // channels past numActiveChannels (an unused sidechain) aren't processed this block, they can't hold a fade up
+    const auto active = channels.begin() + juce::jlimit(0, numChannels, numActiveChannels);
+
+    // the fade ends once every channel in use has been through a partition with both sets
+    if (fadeTarget >= 0 && std::none_of(channels.begin(), active, [](const ChannelState& state) { return state.fadePending; }))
+    {
+        activeSet = fadeTarget;
+        fadeTarget = -1;
+        builderState.store(0, std::memory_order_release);
+
+        for (auto& state : channels)
+            state.fadePending = false;
+    }
+
+    if (fadeTarget < 0 && builderState.load(std::memory_order_acquire) == 2)
+    {
+        fadeTarget = 1 - activeSet;
+        std::for_each(channels.begin(), active, [](ChannelState& state) { state.fadePending = true; });
+    }
+}
+
+
+template <typename SampleType>
+void LinearPhaseCrossover::process(int channel, const SampleType* input, SampleType* const* bandData, int numBands, int numSamples) noexcept
+{
+    auto& state = channels[(size_t) channel];
+
+    for (int done = 0; done < numSamples;)
+    {
+        const int todo = juce::jmin(numSamples - done, partitionSize - state.position);
+
+        // take the input before writing any band, input may be one of them
+        std::copy(input + done, input + done + todo, state.input.data() + partitionSize + state.position);
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            const float* output = state.output.data() + band * partitionSize + state.position;
+            std::copy(output, output + todo, bandData[band] + done);
+        }
+
+        state.position += todo;
+        done += todo;
+
+        if (state.position == partitionSize)
+        {
+            processPartition(channel, numBands);
+            state.position = 0;
+        }
+    }
+}
+
+template void LinearPhaseCrossover::process(int, const float*, float* const*, int, int) noexcept;
+template void LinearPhaseCrossover::process(int, const double*, double* const*, int, int) noexcept;
+
+
+void LinearPhaseCrossover::processPartition(int channel, int numBands) noexcept
+{
+    auto& state = channels[(size_t) channel];
+
+    // spectrum of [previous | current] into the history ring
+    std::copy(state.input.begin(), state.input.end(), fftBuffer.begin());
+    std::fill(fftBuffer.begin() + fftSize, fftBuffer.end(), 0.0f);
+    fft.performRealOnlyForwardTransform(fftBuffer.data(), true);
+
+    state.head = (state.head + 1) % numPartitions;
+    std::copy(fftBuffer.begin(), fftBuffer.begin() + spectrumSize, state.history.data() + state.head * spectrumSize);
+
+    std::copy(state.input.begin() + partitionSize, state.input.end(), state.input.begin());
+
+    // a channel that already faded uses the new set until beginBlock makes it the active one
+    const bool fading = state.fadePending;
+    const KernelSet& set = kernelSets[fadeTarget >= 0 && ! fading ? fadeTarget : activeSet];
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        float* output = state.output.data() + band * partitionSize;
+
+        if (band < set.numBands)
+            convolve(set, band, state, output);
+        else
+            std::fill(output, output + partitionSize, 0.0f);
+
+        if (fading)
+        {
+            const KernelSet& next = kernelSets[fadeTarget];
+
+            if (band < next.numBands)
+                convolve(next, band, state, fadeBuffer.data());
+            else
+                std::fill(fadeBuffer.begin(), fadeBuffer.end(), 0.0f);
+
+            for (int i = 0; i < partitionSize; ++i)
+            {
+                const float ramp = (float) (i + 1) / (float) partitionSize;
+                output[i] += ramp * (fadeBuffer[(size_t) i] - output[i]);
+            }
+        }
+    }
+
+    // a set built for more bands than are running folds the rest into the top band, nothing goes missing
+    float* top = state.output.data() + (numBands - 1) * partitionSize;
+
+    for (int band = numBands; band < maxBands; ++band)
+        juce::FloatVectorOperations::add(top, state.output.data() + band * partitionSize, partitionSize);
+
+    state.fadePending = false;
+}
+
+
+void LinearPhaseCrossover::convolve(const KernelSet& set, int band, const ChannelState& state, float* output) noexcept
+{
+    std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+    float* acc = accumulator.data();
+
+    // partition p of the kernel meets the input spectrum from p partitions ago
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        const int slot = (state.head - partition + numPartitions) % numPartitions;
+        const float* x = state.history.data() + slot * spectrumSize;
+        const float* h = set.get(band, partition);
+
+        for (int bin = 0; bin < spectrumSize; bin += 2)
+        {
+            acc[bin]     += x[bin] * h[bin]     - x[bin + 1] * h[bin + 1];
+            acc[bin + 1] += x[bin] * h[bin + 1] + x[bin + 1] * h[bin];
+        }
+    }
+
+    std::copy(accumulator.begin(), accumulator.end(), fftBuffer.begin());
+    fft.performRealOnlyInverseTransform(fftBuffer.data());
+
+    // overlap-save: only the second half is free of wrap around
+    std::copy(fftBuffer.begin() + partitionSize, fftBuffer.begin() + fftSize, output);
+}
+
+
+int LinearPhaseCrossover::useTimeSlice()
+{
+    if (builderState.load(std::memory_order_acquire) != 0)
+        return 5;
+
+    const int request = requestCount.load(std::memory_order_acquire);
+
+    if (request == builtCount)
+        return 20;
+
+    builderState.store(1, std::memory_order_relaxed);
+
+    // a request landing while we read just gets built again next time
+    const int numBands = requestedBands.load(std::memory_order_relaxed);
+    float frequencies[maxSplits];
+
+    for (int split = 0; split < maxSplits; ++split)
+        frequencies[split] = requestedFrequencies[split].load(std::memory_order_relaxed);
+
+    buildKernels(kernelSets[1 - activeSet], numBands, frequencies);
+    builtCount = request;
+
+    builderState.store(2, std::memory_order_release);
+    return 5;
+}
+
+
+// Kaiser windowed sinc, normalised to exactly 1 at DC
+void LinearPhaseCrossover::designLowPass(std::vector<double>& taps, float frequency) const
+{
+    const double cutoff = juce::jlimit(1.0, sampleRate * 0.49, (double) frequency) / sampleRate;
+    double sum = 0.0;
+
+    for (int n = 0; n < kernelLength; ++n)
+    {
+        const double t = (double) (n - kernelDelay);
+        const double sinc = n == kernelDelay ? 2.0 * cutoff
+                                             : std::sin(juce::MathConstants<double>::twoPi * cutoff * t) / (juce::MathConstants<double>::pi * t);
+        taps[(size_t) n] = sinc * window[(size_t) n];
+        sum += taps[(size_t) n];
+    }
+
+    for (auto& tap : taps)
+        tap /= sum;
+}
+
+
+void LinearPhaseCrossover::buildKernels(KernelSet& set, int numBands, const float* frequencies)
+{
+    numBands = juce::jlimit(2, maxBands, numBands);
+    std::fill(previousLowPass.begin(), previousLowPass.end(), 0.0);
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        // the top band's "low pass" is the plain delay, so all bands sum to it
+        if (band < numBands - 1)
+        {
+            designLowPass(lowPass, frequencies[band]);
+        }
+        else
+        {
+            std::fill(lowPass.begin(), lowPass.end(), 0.0);
+            lowPass[(size_t) kernelDelay] = 1.0;
+        }
+
+        for (int partition = 0; partition < numPartitions; ++partition)
+        {
+            std::fill(builderBuffer.begin(), builderBuffer.end(), 0.0f);
+
+            const int first = partition * partitionSize;
+            const int last = juce::jmin(first + partitionSize, kernelLength);
+
+            for (int n = first; n < last; ++n)
+                builderBuffer[(size_t) (n - first)] = (float) (lowPass[(size_t) n] - previousLowPass[(size_t) n]);
+
+            builderFFT.performRealOnlyForwardTransform(builderBuffer.data(), true);
+
+            float* spectrum = set.spectra.data() + ((size_t) band * numPartitions + (size_t) partition) * spectrumSize;
+            std::copy(builderBuffer.begin(), builderBuffer.begin() + spectrumSize, spectrum);
+        }
+
+        std::swap(lowPass, previousLowPass);
+    }
+
+    set.numBands = numBands;
+}
@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    linearPhaseCrossover.h
+    Created: 17 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Linear phase band split with the same band layout as CrossoverTree (lowest band first, numBands - 1 ascending splits).
+//
+// Band k is the input convolved with LP(k) - LP(k - 1), two Kaiser windowed sinc low passes sharing one centre tap,
+// so the bands add back up to a pure delay. The FIRs run as uniformly partitioned FFT convolution (overlap-save):
+// one forward FFT per channel and partition, shared by every band, then a multiply-add over the partitions and
+// one inverse FFT per band. Latency is partitionSize + kernelDelay samples.
+//
+// When the splits move, the kernel spectra are rebuilt on a background thread into the set the audio thread isn't
+// reading, then faded in over one partition. Both sets read the same input spectra, so the fade only costs the extra
+// multiply-adds and inverse FFTs for that one partition.
+class LinearPhaseCrossover : public juce::TimeSliceClient
+{
+public:
+    static constexpr int maxBands = 5;
+    static constexpr int maxSplits = maxBands - 1;
+
+    static constexpr int partitionSize = 256;
+    static constexpr int fftOrder = 9;
+    static constexpr int fftSize = 1 << fftOrder; // a partition plus the one before it
+    static constexpr int numBins = fftSize / 2 + 1;
+    static constexpr int numPartitions = 16;
+    static constexpr int kernelLength = partitionSize * numPartitions - 1; // odd, the centre tap sits on a sample
+    static constexpr int kernelDelay = kernelLength / 2;
+    static constexpr int latencySamples = partitionSize + kernelDelay;
+
+    LinearPhaseCrossover() : fft(fftOrder), builderFFT(fftOrder) {}
+
+    // MESSAGE THREAD, only while this isn't registered with a thread
+    void prepare(double newSampleRate, int newNumChannels);
+    void buildPendingKernels(); // so the first block after prepare already has kernels
+
+    // AUDIO THREAD
+    void reset();
+    void setSplits(int numBands, const float* frequencies); // only posts the request, the builder picks it up
+    void beginBlock(int numActiveChannels);                 // once per block, before any channel is processed
+
+    // Splits one channel into numBands planar buffers, input may alias any of them.
+    // Double blocks only convert on the way in and out, the convolution runs in float (juce::dsp::FFT is float only)
+    template <typename SampleType>
+    void process(int channel, const SampleType* input, SampleType* const* bandData, int numBands, int numSamples) noexcept;
+
+    // BUILDER THREAD
+    int useTimeSlice() override;
+
+private:
+    // one spectrum is numBins interleaved re / im pairs
+    static constexpr int spectrumSize = 2 * numBins;
+
+    struct KernelSet
+    {
+        int numBands = 0;
+        std::vector<float> spectra; // [band][partition][spectrum]
+
+        const float* get(int band, int partition) const noexcept
+        {
+            return spectra.data() + ((size_t) band * numPartitions + (size_t) partition) * spectrumSize;
+        }
+    };
+
+    struct ChannelState
+    {
+        std::vector<float> input;   // [previous partition | current partition]
+        std::vector<float> history; // input spectra, [partition][spectrum], ring with the newest at head
+        std::vector<float> output;  // [band][partitionSize], what goes out during the current partition
+        int head = 0;
+        int position = 0;
+        bool fadePending = false;   // still has to go through one partition with both sets
+    };
+
+    void buildKernels(KernelSet& set, int numBands, const float* frequencies);
+    void designLowPass(std::vector<double>& taps, float frequency) const;
+
+    void processPartition(int channel, int numBands) noexcept;
+    void convolve(const KernelSet& set, int band, const ChannelState& state, float* output) noexcept;
+
+    double sampleRate = 44100.0;
+    int numChannels = 0;
+
+    // the audio thread reads kernelSets[activeSet], and kernelSets[fadeTarget] while fading
+    KernelSet kernelSets[2];
+    int activeSet = 0;
+    int fadeTarget = -1;
+
+    // 0 = the builder may fill the other set, 1 = building, 2 = built, waiting for the audio thread
+    std::atomic<int> builderState { 0 };
+
+    // latest request from the audio thread, requestCount is bumped after the values are written
+    std::atomic<int> requestedBands { 2 };
+    std::atomic<float> requestedFrequencies[maxSplits] {};
+    std::atomic<int> requestCount { 0 };
+    int builtCount = 0; // builder side
+
+    int lastBands = 0; // audio side, identical requests are dropped
+    float lastFrequencies[maxSplits] = {};
+
+    // audio thread
+    juce::dsp::FFT fft;
+    std::vector<ChannelState> channels; // one per channel of the bus layout
+    std::vector<float> fftBuffer, accumulator, fadeBuffer;
+
+    // builder thread
+    juce::dsp::FFT builderFFT;
+    std::vector<double> window, lowPass, previousLowPass;
+    std::vector<float> builderBuffer;
+
+    JUCE_DECLARE_NON_COPYABLE(LinearPhaseCrossover)
+};
+
+
+// One kernel builder thread for every plugin instance in the process
+struct KernelBuilderThread : public juce::TimeSliceThread
+{
+    KernelBuilderThread() : juce::TimeSliceThread("LABEURRE kernel builder") { startThread(); }
+    ~KernelBuilderThread() override { stopThread(1000); }
+};
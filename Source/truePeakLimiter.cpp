@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    truePeakLimiter.cpp
+    Created: 17 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "truePeakLimiter.h"
+
+template <typename SampleType>
+void TruePeakLimiter<SampleType>::prepare(double sampleRate, int newNumChannels)
+{
+    numChannels = juce::jmax(0, newNumChannels);
+    lookahead = juce::jmax(1, juce::roundToInt(lookaheadMs * 0.001 * sampleRate));
+    releaseCte = (float) std::exp(-1.0 / (releaseMs * 0.001 * sampleRate));
+
+    // windowed sinc at the host Nyquist, centred on a tap of phase 0 so that phase is the plain delay
+    constexpr int length = oversamplingFactor * tapsPerPhase;
+    constexpr int centre = oversamplingFactor * detectorDelay;
+    float window[length + 1];
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(window, (size_t) (length + 1),
+                                                             juce::dsp::WindowingFunction<float>::kaiser, false, 8.0f);
+
+    for (int phase = 0; phase < oversamplingFactor; ++phase)
+    {
+        float sum = 0.0f;
+
+        for (int tap = 0; tap < tapsPerPhase; ++tap)
+        {
+            const int n = tap * oversamplingFactor + phase;
+            const double t = (double) (n - centre) / oversamplingFactor;
+            const double sinc = n == centre ? 1.0 : std::sin(juce::MathConstants<double>::pi * t) / (juce::MathConstants<double>::pi * t);
+
+            phases[phase][tap] = (float) sinc * window[n];
+            sum += phases[phase][tap];
+        }
+
+        // every phase passes DC at unity, a constant never reads as a peak
+        for (auto& coefficient : phases[phase])
+            coefficient /= sum;
+    }
+
+    history.assign((size_t) (numChannels * 2 * tapsPerPhase), SampleType());
+
+    delaySize = juce::nextPowerOfTwo(getLatencySamples() + 1);
+    delay.assign((size_t) (numChannels * delaySize), SampleType());
+
+    // the peak at sample n is read lookahead + 1 samples after it was pushed, see nextGain
+    holdLength = lookahead + 2;
+    holdMask = juce::nextPowerOfTwo(holdLength + 1) - 1;
+    required.assign((size_t) holdMask + 1, 1.0f);
+    minQueue.assign((size_t) holdMask + 1, 0);
+
+    averageLine.assign((size_t) (lookahead + 1), 1.0f);
+
+    reset();
+}
+
+
+template <typename SampleType>
+void TruePeakLimiter<SampleType>::reset()
+{
+    std::fill(history.begin(), history.end(), SampleType());
+    std::fill(delay.begin(), delay.end(), SampleType());
+    std::fill(required.begin(), required.end(), 1.0f);
+    std::fill(averageLine.begin(), averageLine.end(), 1.0f);
+
+    historyIndex = 0;
+    delayWrite = 0;
+    queueHead = queueTail = sampleIndex = 0;
+    averageIndex = 0;
+    averageSum = (double) averageLine.size();
+    released = 1.0f;
+}
+
+
+template <typename SampleType>
+SampleType TruePeakLimiter<SampleType>::pushTruePeak(int channel, SampleType x) noexcept
+{
+    SampleType* line = history.data() + channel * 2 * tapsPerPhase;
+    line[historyIndex] = x;
+    line[historyIndex + tapsPerPhase] = x;
+
+    // line[historyIndex + tapsPerPhase - tap] is x[n - tap]
+    const SampleType* newest = line + historyIndex + tapsPerPhase;
+    SampleType peak = 0;
+
+    for (const auto& phase : phases)
+    {
+        SampleType y = 0;
+
+        for (int tap = 0; tap < tapsPerPhase; ++tap)
+            y += phase[tap] * newest[-tap];
+
+        peak = juce::jmax(peak, std::abs(y));
+    }
+
+    return peak;
+}
+
+
+// Hold the smallest required gain over holdLength samples, release it with a one pole (never above the hold),
+// then average over lookahead + 1 samples: every value in the average already holds the peak's requirement,
+// so the gain is all the way down when the peak's samples leave the delay line
+template <typename SampleType>
+float TruePeakLimiter<SampleType>::nextGain(float requiredGain) noexcept
+{
+    while (queueTail > queueHead && required[(size_t) (minQueue[(size_t) ((queueTail - 1) & holdMask)] & holdMask)] >= requiredGain)
+        --queueTail;
+
+    required[(size_t) (sampleIndex & holdMask)] = requiredGain;
+    minQueue[(size_t) (queueTail++ & holdMask)] = sampleIndex;
+
+    if (minQueue[(size_t) (queueHead & holdMask)] <= sampleIndex - holdLength)
+        ++queueHead;
+
+    ++sampleIndex;
+
+    const float hold = required[(size_t) (minQueue[(size_t) (queueHead & holdMask)] & holdMask)];
+    released = hold < released ? hold : hold + releaseCte * (released - hold);
+
+    averageSum += released - averageLine[(size_t) averageIndex];
+    averageLine[(size_t) averageIndex] = released;
+
+    if (++averageIndex == (int) averageLine.size())
+        averageIndex = 0;
+
+    return (float) (averageSum / (double) averageLine.size());
+}
+
+
+template <typename SampleType>
+void TruePeakLimiter<SampleType>::process(SampleType* const* channelData, int numChannelsToProcess, int numSamples) noexcept
+{
+    numChannelsToProcess = juce::jmin(numChannelsToProcess, numChannels);
+
+    const int latency = getLatencySamples();
+    const int delayMask = delaySize - 1;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        SampleType peak = 0;
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+            peak = juce::jmax(peak, pushTruePeak(channel, channelData[channel][i]));
+
+        historyIndex = (historyIndex + 1) % tapsPerPhase;
+
+        const float gain = nextGain(peak > ceiling ? (float) (ceiling / peak) : 1.0f);
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+        {
+            SampleType* line = delay.data() + channel * delaySize;
+            line[delayWrite] = channelData[channel][i];
+            channelData[channel][i] = line[(delayWrite - latency) & delayMask] * gain;
+        }
+
+        delayWrite = (delayWrite + 1) & delayMask;
+    }
+}
+
+
+template class TruePeakLimiter<float>;
+template class TruePeakLimiter<double>;
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    truePeakLimiter.h
+    Created: 17 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// True peak ceiling for the output, every channel gets the same gain so the image doesn't move.
+//
+// The level is read off a 4x polyphase interpolation of the signal (Kaiser windowed sinc, 12 taps a phase as in
+// BS.1770, one phase is the plain delay), so inter-sample peaks count. The gain that keeps all channels under the
+// ceiling is held over the lookahead window, released with a one pole and then averaged over the window again, which
+// brings it down to what the peak needs by the time the peak leaves the delay line. Latency is detectorDelay + the
+// lookahead, fixed per sample rate. The audio and the interpolated peaks are SampleType, the gain is worked out in float.
+template <typename SampleType>
+class TruePeakLimiter
+{
+public:
+    static constexpr int oversamplingFactor = 4;
+    static constexpr int tapsPerPhase = 12;
+    static constexpr int detectorDelay = tapsPerPhase / 2; // where the interpolator's centre tap sits, in host samples
+    static constexpr float lookaheadMs = 1.5f;
+    static constexpr float releaseMs = 80.0f;
+
+    // MESSAGE THREAD, everything is allocated here
+    void prepare(double sampleRate, int numChannels);
+
+    // AUDIO THREAD
+    void reset();
+    void setCeiling(float ceilingDB) { ceiling = juce::Decibels::decibelsToGain(ceilingDB); }
+    int getLatencySamples() const noexcept { return detectorDelay + lookahead; }
+
+    // in place, up to the number of prepared channels
+    void process(SampleType* const* channelData, int numChannels, int numSamples) noexcept;
+
+private:
+    SampleType pushTruePeak(int channel, SampleType x) noexcept; // largest of the interpolated points ending at x
+    float nextGain(float required) noexcept;
+
+    int numChannels = 0;
+    int lookahead = 0;
+    float ceiling = 1.0f;
+    float releaseCte = 0.0f;
+
+    // interpolator, [phase][tap], and the input history per channel, written twice so the taps read one straight run
+    float phases[oversamplingFactor][tapsPerPhase] = {};
+    std::vector<SampleType> history; // [channel][2 * tapsPerPhase]
+    int historyIndex = 0;
+
+    // audio delay, [channel][delaySize], power of two
+    std::vector<SampleType> delay;
+    int delaySize = 0, delayWrite = 0;
+
+    // sliding minimum over the hold window (monotonic queue of sample indices) and the moving average after it
+    std::vector<float> required;       // [sample index & holdMask]
+    std::vector<juce::int64> minQueue; // [position & holdMask]
+    juce::int64 queueHead = 0, queueTail = 0, sampleIndex = 0;
+    int holdLength = 0, holdMask = 0;
+
+    std::vector<float> averageLine;
+    int averageIndex = 0;
+    double averageSum = 0.0;
+    float released = 1.0f;
+};
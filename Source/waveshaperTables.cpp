@@ -0,0 +1,33 @@
+/*
+  ==============================================================================
+
+    waveshaperTables.cpp
+    Created: 17 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "waveshaperTables.h"
+
+WaveshaperTables::WaveshaperTables()
+    : warmTable((size_t) numU), coreTable((size_t) (numU * numK))
+{
+    // built in double with the exact tanh, the only error left is the interpolation
+    auto shape = [](int i)
+    {
+        const double u = -uLimit + 2.0 * uLimit * i / (numU - 1);
+        const double t = std::tanh(u);
+        return t + 0.15 * t * t * t;
+    };
+
+    for (int i = 0; i < numU; ++i)
+        warmTable[(size_t) i] = (float) shape(i);
+
+    for (int row = 0; row < numK; ++row)
+    {
+        const double k = kMin + (kMax - kMin) * row / (numK - 1);
+
+        for (int i = 0; i < numU; ++i)
+            coreTable[(size_t) (row * numU + i)] = (float) std::tanh(k * shape(i));
+    }
+}
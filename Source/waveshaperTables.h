@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    waveshaperTables.h
+    Created: 17 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// Interpolated lookup tables for the distortion curves, built once and shared read-only
+// by every plugin instance (hold it through juce::SharedResourcePointer).
+//
+// The drive only ever shows up as a scale on the tanh arguments, so it factors out:
+//     WARM(x, d)      = s(d) * h(d x)            h(u) = tanh(u) + 0.15 tanh^3(u),  s(d) = 1 / (1 + 0.295 (d - 1))
+//     tanh(D WARM)    = core(D x, D s(D))        core(u, k) = tanh(k h(u))
+// h is 1-D, core is 2-D over (u, k). k = D s(D) stays inside [1, 1 / 0.295) for any drive >= 1,
+// so the same core table serves CRUSH and the inner stage of DON'T whatever the envelope does.
+class WaveshaperTables
+{
+public:
+    static constexpr float uLimit = 8.0f; // tanh(8) is 1 to within 2.3e-7, everything past that is flat
+    static constexpr int numU = 2049;
+
+    static constexpr float kMin = 1.0f;
+    static constexpr float kMax = 3.4f;
+    static constexpr int numK = 129;
+
+    // Runs on whichever thread creates the first instance (the message thread), never on the audio thread
+    WaveshaperTables();
+
+    static float warmScale(float drive) noexcept { return 1.0f / (1.0f + 0.295f * (drive - 1.0f)); }
+
+    // h(u), linear interpolation
+    float warmShape(float u) const noexcept
+    {
+        int index;
+        const float frac = position(u, index);
+        return warmTable[index] + frac * (warmTable[index + 1] - warmTable[index]);
+    }
+
+    // tanh(k h(u)), bilinear interpolation
+    float core(float u, float k) const noexcept
+    {
+        int index;
+        const float frac = position(u, index);
+
+        const float kPos = (juce::jlimit(kMin, kMax, k) - kMin) * ((numK - 1) / (kMax - kMin));
+        const int row = juce::jmin((int) kPos, numK - 2);
+        const float kFrac = kPos - (float) row;
+
+        const float* r0 = coreTable.data() + row * numU + index;
+        const float* r1 = r0 + numU;
+
+        const float y0 = r0[0] + frac * (r0[1] - r0[0]);
+        const float y1 = r1[0] + frac * (r1[1] - r1[0]);
+        return y0 + kFrac * (y1 - y0);
+    }
+
+    float warm(float x, float drive) const noexcept { return warmScale(drive) * warmShape(drive * x); }
+
+    // tanh(D * WARM(x, D))
+    float crushCore(float x, float dynamicDrive) const noexcept
+    {
+        return core(dynamicDrive * x, dynamicDrive * warmScale(dynamicDrive));
+    }
+
+private:
+    static float position(float u, int& index) noexcept
+    {
+        const float pos = (juce::jlimit(-uLimit, uLimit, u) + uLimit) * ((numU - 1) / (2.0f * uLimit));
+        index = juce::jmin((int) pos, numU - 2);
+        return pos - (float) index;
+    }
+
+    std::vector<float> warmTable;
+    std::vector<float> coreTable; // numK rows of numU
+
+    JUCE_DECLARE_NON_COPYABLE(WaveshaperTables)
+};